@@ -44,10 +44,17 @@
 // STL
 #include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
 #include <algorithm>
 #include <utility>
 #include <fstream>
+#include <random>
 
 // Mathlib
 #include "mathlib/mathlib.h"
@@ -117,6 +124,7 @@
 #include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
 #include <Jolt/Physics/Collision/GroupFilter.h>
 #include <Jolt/Physics/Collision/GroupFilterTable.h>
+#include <Jolt/Geometry/GJKClosestPoint.h>
 #include <Jolt/Physics/Constraints/ConeConstraint.h>
 #include <Jolt/Physics/Constraints/PointConstraint.h>
 #include <Jolt/Physics/Constraints/HingeConstraint.h>
@@ -125,10 +133,12 @@
 #include <Jolt/Physics/Constraints/SixDOFConstraint.h>
 #include <Jolt/Physics/Constraints/DistanceConstraint.h>
 #include <Jolt/Physics/Constraints/SliderConstraint.h>
+#include <Jolt/Physics/Constraints/PulleyConstraint.h>
 #include <Jolt/Physics/Vehicle/VehicleConstraint.h>
 #include <Jolt/Physics/Vehicle/VehicleCollisionTester.h>
 #include <Jolt/Physics/Vehicle/WheeledVehicleController.h>
 
 // Ourselves
+#include "vjolt_extensions.h"
 #include "vjolt_interface.h"
 #include "vjolt_util.h"
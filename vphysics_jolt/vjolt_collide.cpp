@@ -6,6 +6,7 @@
 
 #include "vjolt_parse.h"
 #include "vjolt_querymodel.h"
+#include "vjolt_surfaceprops.h"
 
 #include "vjolt_collide.h"
 
@@ -19,6 +20,7 @@ static constexpr float kMaxConvexRadius = JPH::cDefaultConvexRadius;
 
 JoltPhysicsCollision JoltPhysicsCollision::s_PhysicsCollision;
 EXPOSE_SINGLE_INTERFACE_GLOBALVAR( JoltPhysicsCollision, IPhysicsCollision, VPHYSICS_COLLISION_INTERFACE_VERSION, JoltPhysicsCollision::GetInstance() );
+EXPOSE_SINGLE_INTERFACE_GLOBALVAR( JoltPhysicsCollision, IJoltPhysicsCollisionExt, VJOLT_PHYSICS_COLLISION_EXT_INTERFACE_VERSION, JoltPhysicsCollision::GetInstance() );
 
 //-------------------------------------------------------------------------------------------------
 
@@ -56,6 +58,236 @@ CPhysCollide *ShapeSettingsToPhysCollide( const T& settings )
 	return CPhysCollide::FromShape( ShapeSettingsToShape< JPH::Shape >( settings ) );
 }
 
+// Jolt works out which mesh edges are active when the mesh is built, so things sliding
+// across the mesh don't catch on the seams between triangles. But an edge shared by more than
+// two triangles is always active, and putting both windings of a two-faced mesh in the one
+// MeshShape makes every edge shared by four. Build each winding as its own mesh instead so
+// they both get proper active edges, and put them together in a compound.
+static CPhysCollide *TwoSidedMeshToPhysCollide( const JPH::MeshShapeSettings *pFrontSettings, const JPH::MeshShapeSettings *pBackSettings )
+{
+	JPH::StaticCompoundShapeSettings settings;
+	settings.AddShape( JPH::Vec3::sZero(), JPH::Quat::sIdentity(), pFrontSettings );
+	settings.AddShape( JPH::Vec3::sZero(), JPH::Quat::sIdentity(), pBackSettings );
+	return ShapeSettingsToPhysCollide( settings );
+}
+
+//-------------------------------------------------------------------------------------------------
+// Collide info
+//-------------------------------------------------------------------------------------------------
+
+// Source only gives convexes 32 bits of game data, so the top half of a shape's user data
+// is free. We keep a handle to extra info about the collide in there, like its areas which
+// get worked out once when a collide is made or loaded, so looking them up later does not
+// need to touch the shape.
+struct CollideInfo_t
+{
+	float		flSurfaceArea;
+	JPH::Vec3	vecOrthoAreas;
+
+	// From CollideSetMassCenter, applied when an object is made from the collide.
+	JPH::Vec3	vecMassCenterOverride;
+	bool		bMassCenterOverride;
+
+	// Index of the solid in the vcollide this was loaded from.
+	int			nIndex;
+};
+
+// Infos live in fixed size chunks that are never moved or freed, so a handle can be read
+// without taking the lock. The lock is only for handing out and taking back handles.
+static constexpr uint32 kCollideInfoChunkSize = 1024;
+static constexpr uint32 kMaxCollideInfoChunks = 4096;
+
+static std::mutex s_CollideInfoLock;
+static std::atomic< CollideInfo_t * > s_CollideInfoChunks[ kMaxCollideInfoChunks ];
+static uint32 s_nCollideInfos = 0;
+static std::vector< uint32 > s_FreeCollideInfos;
+
+static uint32 GetCollideInfoHandle( const JPH::Shape *pShape )
+{
+	return uint32( pShape->GetUserData() >> 32 );
+}
+
+static void SetCollideInfoHandle( JPH::Shape *pShape, uint32 nHandle )
+{
+	pShape->SetUserData( ( pShape->GetUserData() & 0xFFFFFFFFull ) | ( uint64( nHandle ) << 32 ) );
+}
+
+static CollideInfo_t &GetCollideInfoSlot( uint32 nHandle )
+{
+	const uint32 nSlot = nHandle - 1;
+	CollideInfo_t *pChunk = s_CollideInfoChunks[ nSlot / kCollideInfoChunkSize ].load( std::memory_order_acquire );
+	return pChunk[ nSlot % kCollideInfoChunkSize ];
+}
+
+static CollideInfo_t ComputeCollideInfo( const JPH::Shape *pShape, bool bTwoSided = false )
+{
+	JPH::AllHitCollisionCollector< JPH::TransformedShapeCollector > collector;
+	JPH::ShapeFilter filter;
+	pShape->CollectTransformedShapes( JPH::AABox::sBiggest(), pShape->GetCenterOfMass(), JPH::Quat::sIdentity(), JPH::Vec3::sReplicate( 1.0f ), JPH::SubShapeIDCreator(), collector, filter );
+
+	// Sum up the area of every triangle, and the area of each of them projected
+	// onto the planes facing down each axis.
+	float flSurfaceArea = 0.0f;
+	JPH::Vec3 vecProjectedAreas = JPH::Vec3::sZero();
+	for ( const JPH::TransformedShape &shape : collector.mHits )
+	{
+		JPH::Shape::GetTrianglesContext ctx;
+		shape.GetTrianglesStart( ctx, JPH::AABox::sBiggest(), JPH::Vec3::sZero() );
+		for ( ;; )
+		{
+			JPH::Float3 vertices[ JPH::Shape::cGetTrianglesMinTrianglesRequested * 3 ];
+			const int nCount = shape.GetTrianglesNext( ctx, JPH::Shape::cGetTrianglesMinTrianglesRequested, vertices, nullptr /* materials */ );
+			if ( nCount == 0 )
+				break;
+
+			for ( int i = 0; i < nCount; i++ )
+			{
+				const JPH::Vec3 v0( vertices[ i * 3 + 0 ] );
+				const JPH::Vec3 v1( vertices[ i * 3 + 1 ] );
+				const JPH::Vec3 v2( vertices[ i * 3 + 2 ] );
+
+				const JPH::Vec3 vecCross = ( v1 - v0 ).Cross( v2 - v0 );
+				flSurfaceArea += 0.5f * vecCross.Length();
+				vecProjectedAreas += 0.5f * vecCross.Abs();
+			}
+		}
+	}
+
+	// A two-sided mesh has every triangle in it twice, once for each winding.
+	if ( bTwoSided )
+		flSurfaceArea *= 0.5f;
+
+	// A closed surface covers every projection twice, once from each side, and so
+	// does a two-sided mesh.
+	// The orthographic areas are how much of the matching face of the bounding box
+	// the shape covers, like studiomdl computes them for IVP.
+	const JPH::Vec3 vecSize = pShape->GetLocalBounds().GetSize();
+	const JPH::Vec3 vecFaceAreas = JPH::Vec3( vecSize.GetY() * vecSize.GetZ(), vecSize.GetX() * vecSize.GetZ(), vecSize.GetX() * vecSize.GetY() );
+
+	CollideInfo_t info;
+	info.flSurfaceArea = JoltToSource::Area( flSurfaceArea );
+	info.vecOrthoAreas = JPH::Vec3::sReplicate( 1.0f );
+	info.vecMassCenterOverride = JPH::Vec3::sZero();
+	info.bMassCenterOverride = false;
+	info.nIndex = 0;
+	for ( int i = 0; i < 3; i++ )
+	{
+		if ( vecFaceAreas[ i ] > FLT_EPSILON )
+			info.vecOrthoAreas.SetComponent( i, Clamp( 0.5f * vecProjectedAreas[ i ] / vecFaceAreas[ i ], 0.0f, 1.0f ) );
+	}
+	return info;
+}
+
+static void StoreCollideInfo( JPH::Shape *pShape, const CollideInfo_t &info )
+{
+	std::unique_lock lock( s_CollideInfoLock );
+
+	uint32 nHandle = GetCollideInfoHandle( pShape );
+	if ( !nHandle )
+	{
+		if ( !s_FreeCollideInfos.empty() )
+		{
+			nHandle = s_FreeCollideInfos.back();
+			s_FreeCollideInfos.pop_back();
+		}
+		else
+		{
+			const uint32 nChunk = s_nCollideInfos / kCollideInfoChunkSize;
+			if ( nChunk >= kMaxCollideInfoChunks )
+			{
+				Log_Warning( LOG_VJolt, "Out of collide info slots, areas and mass center overrides will not be kept.\n" );
+				return;
+			}
+
+			if ( !s_CollideInfoChunks[ nChunk ].load( std::memory_order_relaxed ) )
+				s_CollideInfoChunks[ nChunk ].store( new CollideInfo_t[ kCollideInfoChunkSize ], std::memory_order_release );
+
+			nHandle = ++s_nCollideInfos;
+		}
+		GetCollideInfoSlot( nHandle ) = info;
+		SetCollideInfoHandle( pShape, nHandle );
+		return;
+	}
+
+	GetCollideInfoSlot( nHandle ) = info;
+}
+
+static bool TryGetCollideInfo( const JPH::Shape *pShape, CollideInfo_t &info )
+{
+	const uint32 nHandle = GetCollideInfoHandle( pShape );
+	if ( !nHandle )
+		return false;
+
+	info = GetCollideInfoSlot( nHandle );
+	return true;
+}
+
+static CollideInfo_t GetCollideInfo( const JPH::Shape *pShape )
+{
+	CollideInfo_t info;
+	if ( TryGetCollideInfo( pShape, info ) )
+		return info;
+
+	// Not one we made, ie. a loose convex. Just work it out.
+	return ComputeCollideInfo( pShape );
+}
+
+// Hands the info of the shape, and of any shapes inside of it that go away with it,
+// back to be reused. Call this only when the shape is about to be deleted.
+static void FreeCollideInfo( const JPH::Shape *pShape )
+{
+	if ( GetCollideInfoHandle( pShape ) )
+	{
+		std::unique_lock lock( s_CollideInfoLock );
+		s_FreeCollideInfos.push_back( GetCollideInfoHandle( pShape ) );
+		SetCollideInfoHandle( const_cast< JPH::Shape * >( pShape ), 0 );
+	}
+
+	// Anything only this shape holds on to dies with it.
+	if ( pShape->GetType() == JPH::EShapeType::Decorated )
+	{
+		const JPH::Shape *pInnerShape = static_cast< const JPH::DecoratedShape * >( pShape )->GetInnerShape();
+		if ( pInnerShape->GetRefCount() == 1 )
+			FreeCollideInfo( pInnerShape );
+	}
+	else if ( pShape->GetType() == JPH::EShapeType::Compound )
+	{
+		for ( const JPH::CompoundShape::SubShape &subShape : static_cast< const JPH::CompoundShape * >( pShape )->GetSubShapes() )
+		{
+			if ( subShape.mShape->GetRefCount() == 1 )
+				FreeCollideInfo( subShape.mShape );
+		}
+	}
+}
+
+void ReleaseCollideInfo( const JPH::Shape *pShape )
+{
+	if ( pShape && pShape->GetRefCount() == 1 )
+		FreeCollideInfo( pShape );
+}
+
+static CPhysCollide *CacheCollideInfo( CPhysCollide *pCollide, int nIndex = 0, bool bTwoSided = false )
+{
+	if ( pCollide )
+	{
+		CollideInfo_t info = ComputeCollideInfo( pCollide->ToShape(), bTwoSided );
+		info.nIndex = nIndex;
+		StoreCollideInfo( pCollide->ToShape(), info );
+	}
+
+	return pCollide;
+}
+
+bool GetCollideMassCenterOverride( const JPH::Shape *pShape, JPH::Vec3 &vecMassCenter )
+{
+	CollideInfo_t info;
+	if ( !TryGetCollideInfo( pShape, info ) || !info.bMassCenterOverride )
+		return false;
+
+	vecMassCenter = info.vecMassCenterOverride;
+	return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 
 CPhysConvex *JoltPhysicsCollision::ConvexFromVerts( Vector **pVerts, int vertCount )
@@ -89,18 +321,21 @@ float JoltPhysicsCollision::ConvexVolume( CPhysConvex *pConvex )
 
 float JoltPhysicsCollision::ConvexSurfaceArea( CPhysConvex *pConvex )
 {
-	Log_Stub( LOG_VJolt );
-	return 0.0f;
+	return GetCollideInfo( pConvex->ToConvexShape() ).flSurfaceArea;
 }
 
 void JoltPhysicsCollision::SetConvexGameData( CPhysConvex *pConvex, unsigned int gameData )
 {
-	pConvex->ToConvexShape()->SetUserData( gameData );
+	// Keep the collide info handle in the top half.
+	JPH::ConvexShape *pConvexShape = pConvex->ToConvexShape();
+	pConvexShape->SetUserData( ( pConvexShape->GetUserData() & 0xFFFFFFFF00000000ull ) | uint64( gameData ) );
 }
 
 void JoltPhysicsCollision::ConvexFree( CPhysConvex *pConvex )
 {
-	pConvex->ToConvexShape()->Release();
+	JPH::ConvexShape *pConvexShape = pConvex->ToConvexShape();
+	ReleaseCollideInfo( pConvexShape );
+	pConvexShape->Release();
 }
 
 CPhysConvex *JoltPhysicsCollision::BBoxToConvex( const Vector &mins, const Vector &maxs )
@@ -128,10 +363,110 @@ CPhysConvex *JoltPhysicsCollision::ConvexFromConvexPolyhedron( const CPolyhedron
 	return pPhysConvex;
 }
 
+// How far back from the polygon ConvexesFromConvexPolygon extrudes its convexes, in inches.
+static constexpr float kPolygonConvexThickness = 1.0f;
+
+// Points closer than this are the same point, and a corner with less area than this is a straight line.
+// Both in meters.
+static constexpr float kPolygonPointEpsilon = 1.0e-3f;
+static constexpr float kPolygonAreaEpsilon = 1.0e-6f;
+
+// Box around some points, for when they don't make a hull.
+static CPhysConvex *PointsToBoundsConvex( const JPH::Vec3 *pPoints, int nPointCount )
+{
+	JPH::AABox aabox;
+	for ( int i = 0; i < nPointCount; i++ )
+		aabox.Encapsulate( pPoints[ i ] );
+
+	// Flat or not, give it some thickness on every axis.
+	aabox.ExpandBy( JPH::Vec3::sReplicate( SourceToJolt::Distance( kPolygonConvexThickness ) * 0.5f ) );
+
+	JPH::BoxShape *pBoxShape = new JPH::BoxShape( aabox.GetExtent(), 0.0f, nullptr /* material */ );
+
+	JPH::RotatedTranslatedShapeSettings rotatedSettings( aabox.GetCenter(), JPH::Quat::sIdentity(), pBoxShape );
+	return ShapeSettingsToPhysConvex( rotatedSettings );
+}
+
 void JoltPhysicsCollision::ConvexesFromConvexPolygon( const Vector &vPolyNormal, const Vector *pPoints, int iPointCount, CPhysConvex **pOutput )
 {
-	// Slart: Unused
-	Log_Stub( LOG_VJolt );
+	// Like IVP, this gives back one convex per triangle in a fan of the polygon, so callers
+	// can size pOutput as iPointCount - 2. IVP could have flat ledges, Jolt can't, so each
+	// triangle is extruded back along the normal into a thin prism. These are tiny hulls
+	// that build far quicker than a MeshShape for the same polygon would.
+	if ( iPointCount < 3 )
+		return;
+
+	std::vector< JPH::Vec3 > points;
+	points.reserve( iPointCount );
+	for ( int i = 0; i < iPointCount; i++ )
+		points.push_back( SourceToJolt::Distance( pPoints[ i ] ) );
+
+	// Repeated points and points on a straight edge make fan triangles with no area, and the
+	// prism for one of those is flat, which Jolt can't hull. Drop them first.
+	std::vector< JPH::Vec3 > fanPoints;
+	fanPoints.reserve( iPointCount );
+	for ( const JPH::Vec3 &vecPoint : points )
+	{
+		if ( fanPoints.empty() || !vecPoint.IsClose( fanPoints.back(), kPolygonPointEpsilon * kPolygonPointEpsilon ) )
+			fanPoints.push_back( vecPoint );
+	}
+	if ( fanPoints.size() > 1 && fanPoints.front().IsClose( fanPoints.back(), kPolygonPointEpsilon * kPolygonPointEpsilon ) )
+		fanPoints.pop_back();
+
+	for ( size_t i = 0; fanPoints.size() >= 3 && i < fanPoints.size(); )
+	{
+		const JPH::Vec3 &vecPrev = fanPoints[ ( i + fanPoints.size() - 1 ) % fanPoints.size() ];
+		const JPH::Vec3 &vecNext = fanPoints[ ( i + 1 ) % fanPoints.size() ];
+		if ( ( fanPoints[ i ] - vecPrev ).Cross( vecNext - fanPoints[ i ] ).LengthSq() < kPolygonAreaEpsilon * kPolygonAreaEpsilon )
+		{
+			fanPoints.erase( fanPoints.begin() + i );
+			// The corner before this one has a new neighbour now.
+			if ( i > 0 )
+				i--;
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	const JPH::Vec3 vecExtrude = SourceToJolt::Distance( vPolyNormal * -kPolygonConvexThickness );
+	const int nFanTriangles = fanPoints.size() >= 3 ? int( fanPoints.size() ) - 2 : 0;
+
+	// Every slot gets a convex, the caller uses all of them. Any slots past the triangles we
+	// kept get another copy of the first one, so they don't add anything that isn't there.
+	for ( int i = 0; i < iPointCount - 2; i++ )
+	{
+		CPhysConvex *pConvex = nullptr;
+		if ( nFanTriangles > 0 )
+		{
+			const int nTriangle = i < nFanTriangles ? i : 0;
+			const JPH::Vec3 verts[ 6 ] =
+			{
+				fanPoints[ 0 ],
+				fanPoints[ nTriangle + 1 ],
+				fanPoints[ nTriangle + 2 ],
+				fanPoints[ 0 ] + vecExtrude,
+				fanPoints[ nTriangle + 1 ] + vecExtrude,
+				fanPoints[ nTriangle + 2 ] + vecExtrude,
+			};
+
+			// No convex radius, these are too thin for one.
+			JPH::ConvexHullShapeSettings settings( verts, 6, 0.0f, nullptr /* material */ );
+			settings.mHullTolerance = 0.0f;
+			pConvex = ShapeSettingsToPhysConvex( settings );
+
+			if ( !pConvex )
+				pConvex = PointsToBoundsConvex( verts, 6 );
+		}
+		else
+		{
+			// The whole polygon is a line or a point, this is as close as we can get.
+			pConvex = PointsToBoundsConvex( points.data(), iPointCount );
+		}
+
+		pOutput[ i ] = pConvex;
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -149,8 +484,10 @@ void JoltPhysicsCollision::PolysoupDestroy( CPhysPolysoup *pSoup )
 void JoltPhysicsCollision::PolysoupAddTriangle( CPhysPolysoup *pSoup, const Vector &a, const Vector &b, const Vector &c, int materialIndex7bits )
 {
 	// Add both windings to make this two-faced.
-	pSoup->Triangles.push_back( JPH::Triangle( SourceToJolt::DistanceFloat3( c ), SourceToJolt::DistanceFloat3( b ), SourceToJolt::DistanceFloat3( a ) ) );
-	pSoup->Triangles.push_back( JPH::Triangle( SourceToJolt::DistanceFloat3( a ), SourceToJolt::DistanceFloat3( b ), SourceToJolt::DistanceFloat3( c ) ) );
+	// The material index is the 7-bit world one for now, this gets compacted in ConvertPolysoupToCollide.
+	const uint32 nMaterialIndex = uint32( materialIndex7bits ) & 0x7F;
+	pSoup->Triangles.push_back( JPH::Triangle( SourceToJolt::DistanceFloat3( c ), SourceToJolt::DistanceFloat3( b ), SourceToJolt::DistanceFloat3( a ), nMaterialIndex ) );
+	pSoup->Triangles.push_back( JPH::Triangle( SourceToJolt::DistanceFloat3( a ), SourceToJolt::DistanceFloat3( b ), SourceToJolt::DistanceFloat3( c ), nMaterialIndex ) );
 }
 
 CPhysCollide *JoltPhysicsCollision::ConvertPolysoupToCollide( CPhysPolysoup *pSoup, bool useMOPP )
@@ -160,9 +497,44 @@ CPhysCollide *JoltPhysicsCollision::ConvertPolysoupToCollide( CPhysPolysoup *pSo
 	if ( useMOPP )
 		return nullptr;
 
+	// MeshShape only has a handful of bits for the material on each triangle,
+	// so build a list of just the world materials this soup uses.
+	static constexpr size_t kMaxMeshMaterials = 32;
+
+	std::array< int, 128 > materialSlots;
+	materialSlots.fill( -1 );
+
+	JPH::PhysicsMaterialList materials;
+
+	// The windings alternate, see PolysoupAddTriangle.
+	JPH::TriangleList windingTriangles[ 2 ];
+	windingTriangles[ 0 ].reserve( pSoup->Triangles.size() / 2 );
+	windingTriangles[ 1 ].reserve( pSoup->Triangles.size() / 2 );
+
+	for ( size_t i = 0; i < pSoup->Triangles.size(); i++ )
+	{
+		JPH::Triangle &triangle = windingTriangles[ i % 2 ].emplace_back( pSoup->Triangles[ i ] );
+		int &nSlot = materialSlots[ triangle.mMaterialIndex ];
+		if ( nSlot < 0 )
+		{
+			if ( materials.size() < kMaxMeshMaterials )
+			{
+				nSlot = int( materials.size() );
+				materials.push_back( JoltPhysicsSurfaceProps::GetInstance().GetWorldMaterial( int( triangle.mMaterialIndex ) ) );
+			}
+			else
+			{
+				Log_Warning( LOG_VJolt, "ConvertPolysoupToCollide: More than %d materials on one polysoup, using the first for the rest.\n", int( kMaxMeshMaterials ) );
+				nSlot = 0;
+			}
+		}
+		triangle.mMaterialIndex = uint32( nSlot );
+	}
+
 	// ConvertPolysoupToCollide does NOT free the Polysoup.
-	JPH::MeshShapeSettings settings( pSoup->Triangles );
-	return ShapeSettingsToPhysCollide( settings );
+	return CacheCollideInfo( TwoSidedMeshToPhysCollide(
+		new JPH::MeshShapeSettings( windingTriangles[ 0 ], materials ),
+		new JPH::MeshShapeSettings( windingTriangles[ 1 ], materials ) ), 0, true /* bTwoSided */ );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -172,17 +544,20 @@ CPhysCollide *JoltPhysicsCollision::ConvertConvexToCollide( CPhysConvex **pConve
 	// If we only have one convex shape, we can just use that directly,
 	// without making a compound shape.
 	if ( convexCount == 1 )
-		return pConvex[0]->ToPhysCollide();
+		return CacheCollideInfo( pConvex[0]->ToPhysCollide() );
 
 	JPH::StaticCompoundShapeSettings settings;
 	for ( int i = 0; i < convexCount; i++ )
 		settings.AddShape( JPH::Vec3::sZero(), JPH::Quat::sIdentity(), pConvex[i]->ToConvexShape() );
 
-	CPhysCollide *pCollide = ShapeSettingsToPhysCollide( settings );
+	CPhysCollide *pCollide = CacheCollideInfo( ShapeSettingsToPhysCollide( settings ) );
 
 	// This function also 'frees' the convexes.
 	for ( int i = 0; i < convexCount; i++ )
+	{
+		ReleaseCollideInfo( pConvex[i]->ToConvexShape() );
 		pConvex[i]->ToConvexShape()->Release();
+	}
 
 	return pCollide;
 }
@@ -198,7 +573,9 @@ void JoltPhysicsCollision::DestroyCollide( CPhysCollide *pCollide )
 	if ( !pCollide )
 		return;
 
-	pCollide->ToShape()->Release();
+	JPH::Shape *pShape = pCollide->ToShape();
+	ReleaseCollideInfo( pShape );
+	pShape->Release();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -230,8 +607,7 @@ float JoltPhysicsCollision::CollideVolume( CPhysCollide *pCollide )
 
 float JoltPhysicsCollision::CollideSurfaceArea( CPhysCollide *pCollide )
 {
-	Log_Stub( LOG_VJolt );
-	return 0.0f;
+	return GetCollideInfo( pCollide->ToShape() ).flSurfaceArea;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -289,42 +665,53 @@ void JoltPhysicsCollision::CollideGetAABB( Vector *pMins, Vector *pMaxs, const C
 
 void JoltPhysicsCollision::CollideGetMassCenter( CPhysCollide *pCollide, Vector *pOutMassCenter )
 {
-	*pOutMassCenter = JoltToSource::Distance( pCollide->ToShape()->GetCenterOfMass() );
+	JPH::Vec3 vecMassCenter;
+	if ( !GetCollideMassCenterOverride( pCollide->ToShape(), vecMassCenter ) )
+		vecMassCenter = pCollide->ToShape()->GetCenterOfMass();
+
+	*pOutMassCenter = JoltToSource::Distance( vecMassCenter );
 }
 
 void JoltPhysicsCollision::CollideSetMassCenter( CPhysCollide *pCollide, const Vector &massCenter )
 {
-	// Slart: Only used in studiomdl
-	Log_Stub( LOG_VJolt );
+	// Shapes can't be changed once they are made, and the game holds onto this pointer,
+	// so keep the override with the collide and wrap the shape with CreateCOMOverrideShape
+	// when an object gets made from it instead. That way the hull is never copied.
+	CollideInfo_t info = GetCollideInfo( pCollide->ToShape() );
+	info.vecMassCenterOverride = SourceToJolt::Distance( massCenter );
+	info.bMassCenterOverride = true;
+	StoreCollideInfo( pCollide->ToShape(), info );
 }
 
 Vector JoltPhysicsCollision::CollideGetOrthographicAreas( const CPhysCollide *pCollide )
 {
-	// Slart: Only used in studiomdl... In a part that is #if 0'd out...
-	Log_Stub( LOG_VJolt );
-	return vec3_origin;
+	const JPH::Vec3 vecOrthoAreas = GetCollideInfo( pCollide->ToShape() ).vecOrthoAreas;
+	return Vector( vecOrthoAreas.GetX(), vecOrthoAreas.GetY(), vecOrthoAreas.GetZ() );
 }
 
 void JoltPhysicsCollision::CollideSetOrthographicAreas( CPhysCollide *pCollide, const Vector &areas )
 {
-	// Slart: Never used
-	Log_Stub( LOG_VJolt );
+	CollideInfo_t info = GetCollideInfo( pCollide->ToShape() );
+	info.vecOrthoAreas = JPH::Vec3( areas.x, areas.y, areas.z );
+	StoreCollideInfo( pCollide->ToShape(), info );
 }
 
 //-------------------------------------------------------------------------------------------------
 
 int JoltPhysicsCollision::CollideIndex( const CPhysCollide *pCollide )
 {
-	// Slart: Only used by code behind #ifdef _DEBUG
-	Log_Stub( LOG_VJolt );
-	return 0;
+	CollideInfo_t info;
+	if ( !TryGetCollideInfo( pCollide->ToShape(), info ) )
+		return 0;
+
+	return info.nIndex;
 }
 
 //-------------------------------------------------------------------------------------------------
 
 CPhysCollide *JoltPhysicsCollision::BBoxToCollide( const Vector &mins, const Vector &maxs )
 {
-	return BBoxToConvex( mins, maxs )->ToPhysCollide();
+	return CacheCollideInfo( BBoxToConvex( mins, maxs )->ToPhysCollide() );
 }
 
 int JoltPhysicsCollision::GetConvexesUsedInCollideable( const CPhysCollide *pCollideable, CPhysConvex **pOutputArray, int iOutputArrayLimit )
@@ -349,11 +736,141 @@ int JoltPhysicsCollision::GetConvexesUsedInCollideable( const CPhysCollide *pCol
 
 //-------------------------------------------------------------------------------------------------
 
+// Everything about a cone we need to test boxes against it, worked out once per cone.
+struct ConeTest_t
+{
+	ConeTest_t( const truncatedcone_t &cone )
+	{
+		vecApex = JPH::Vec3( cone.origin.x, cone.origin.y, cone.origin.z );
+		vecAxis = JPH::Vec3( cone.normal.x, cone.normal.y, cone.normal.z ).NormalizedOr( JPH::Vec3::sAxisZ() );
+		flHeight = cone.h;
+		flCosTheta = cosf( DEG2RAD( cone.theta ) );
+		flSinTheta = sinf( DEG2RAD( cone.theta ) );
+		flRadius = cone.h * tanf( DEG2RAD( cone.theta ) );
+		vecBaseCenter = vecApex + vecAxis * flHeight;
+		flApexDist = vecAxis.Dot( vecApex );
+	}
+
+	// Support function for GJK.
+	JPH::Vec3 GetSupport( JPH::Vec3Arg inDirection ) const
+	{
+		// The furthest point on the base's rim, or the apex if that is further.
+		const JPH::Vec3 vecPerp = inDirection - inDirection.Dot( vecAxis ) * vecAxis;
+		const JPH::Vec3 vecRim = vecBaseCenter + vecPerp.NormalizedOr( JPH::Vec3::sZero() ) * flRadius;
+		return inDirection.Dot( vecRim ) > inDirection.Dot( vecApex ) ? vecRim : vecApex;
+	}
+
+	JPH::Vec3	vecApex;
+	JPH::Vec3	vecAxis;
+	JPH::Vec3	vecBaseCenter;
+	float		flHeight;
+	float		flRadius;
+	float		flCosTheta;
+	float		flSinTheta;
+	float		flApexDist;
+};
+
+static bool IsBoxIntersectingCone( JPH::Vec3Arg vecMins, JPH::Vec3Arg vecMaxs, const ConeTest_t &cone )
+{
+	const JPH::Vec3 vecCenter = 0.5f * ( vecMins + vecMaxs );
+	const JPH::Vec3 vecExtents = 0.5f * ( vecMaxs - vecMins );
+
+	// The box has to overlap the slab between the apex and the base.
+	const float flCenterDist = cone.vecAxis.Dot( vecCenter ) - cone.flApexDist;
+	const float flProjectedExtent = cone.vecAxis.Abs().Dot( vecExtents );
+	if ( flCenterDist + flProjectedExtent < 0.0f || flCenterDist - flProjectedExtent > cone.flHeight )
+		return false;
+
+	// Test the box's bounding sphere against the infinite cone.
+	const JPH::Vec3 vecToCenter = vecCenter - cone.vecApex;
+	const float flAxial = vecToCenter.Dot( cone.vecAxis );
+	const float flRadial = sqrtf( Max( vecToCenter.LengthSq() - flAxial * flAxial, 0.0f ) );
+	const float flSphereRadius = vecExtents.Length();
+	const float flConeDist = flRadial * cone.flCosTheta - flAxial * cone.flSinTheta;
+
+	// Sphere is entirely outside of the cone's side.
+	if ( flConeDist >= flSphereRadius )
+		return false;
+
+	// Sphere is entirely inside of the cone's side, and the slab test above
+	// says the centre is between the caps.
+	if ( flConeDist <= -flSphereRadius && flCenterDist >= 0.0f && flCenterDist <= cone.flHeight )
+		return true;
+
+	// Close call, let GJK decide.
+	JPH::AABox box( vecMins, vecMaxs );
+	JPH::Vec3 v = vecCenter - ( cone.vecApex + cone.vecBaseCenter ) * 0.5f;
+	if ( v.IsNearZero() )
+		return true;
+
+	JPH::GJKClosestPoint gjk;
+	return gjk.Intersects( cone, box, 1.0e-3f, v );
+}
+
 bool JoltPhysicsCollision::IsBoxIntersectingCone( const Vector &boxAbsMins, const Vector &boxAbsMaxs, const truncatedcone_t &cone )
 {
-	// Slart: Never used
-	Log_Stub( LOG_VJolt );
-	return false;
+	return ::IsBoxIntersectingCone( JPH::Vec3( boxAbsMins.x, boxAbsMins.y, boxAbsMins.z ), JPH::Vec3( boxAbsMaxs.x, boxAbsMaxs.y, boxAbsMaxs.z ), ConeTest_t( cone ) );
+}
+
+int JoltPhysicsCollision::AreBoxesIntersectingCone( const Vector *pBoxAbsMins, const Vector *pBoxAbsMaxs, int nBoxCount, const truncatedcone_t &cone, bool *pOutResults )
+{
+	const ConeTest_t coneTest( cone );
+
+	int nIntersecting = 0;
+	for ( int i = 0; i < nBoxCount; i++ )
+	{
+		const bool bIntersecting = ::IsBoxIntersectingCone(
+			JPH::Vec3( pBoxAbsMins[ i ].x, pBoxAbsMins[ i ].y, pBoxAbsMins[ i ].z ),
+			JPH::Vec3( pBoxAbsMaxs[ i ].x, pBoxAbsMaxs[ i ].y, pBoxAbsMaxs[ i ].z ),
+			coneTest );
+
+		pOutResults[ i ] = bIntersecting;
+		nIntersecting += bIntersecting ? 1 : 0;
+	}
+
+	return nIntersecting;
+}
+
+CON_COMMAND( vjolt_cone_benchmark, "Times testing boxes against a cone one at a time against the batched call" )
+{
+	const int nBoxCount = args.ArgC() > 1 ? Max( V_atoi( args[ 1 ] ), 1 ) : 10000;
+
+	// Fixed seed so runs are comparable.
+	std::mt19937 rng( 1234 );
+	std::uniform_real_distribution< float > posDist( -512.0f, 512.0f );
+	std::uniform_real_distribution< float > sizeDist( 1.0f, 64.0f );
+
+	std::vector< Vector > boxMins( nBoxCount );
+	std::vector< Vector > boxMaxs( nBoxCount );
+	for ( int i = 0; i < nBoxCount; i++ )
+	{
+		boxMins[ i ] = Vector( posDist( rng ), posDist( rng ), posDist( rng ) );
+		boxMaxs[ i ] = boxMins[ i ] + Vector( sizeDist( rng ), sizeDist( rng ), sizeDist( rng ) );
+	}
+
+	truncatedcone_t cone;
+	cone.origin = Vector( -256.0f, 0.0f, 0.0f );
+	cone.normal = Vector( 1.0f, 0.0f, 0.0f );
+	cone.h = 768.0f;
+	cone.theta = 30.0f;
+
+	JoltPhysicsCollision &collision = JoltPhysicsCollision::GetInstance();
+
+	int nSingleIntersecting = 0;
+	const double flSingleStart = Plat_FloatTime();
+	for ( int i = 0; i < nBoxCount; i++ )
+		nSingleIntersecting += collision.IsBoxIntersectingCone( boxMins[ i ], boxMaxs[ i ], cone ) ? 1 : 0;
+	const double flSingleTime = Plat_FloatTime() - flSingleStart;
+
+	std::unique_ptr< bool[] > pResults = std::make_unique< bool[] >( nBoxCount );
+	const double flBatchedStart = Plat_FloatTime();
+	const int nBatchedIntersecting = collision.AreBoxesIntersectingCone( boxMins.data(), boxMaxs.data(), nBoxCount, cone, pResults.get() );
+	const double flBatchedTime = Plat_FloatTime() - flBatchedStart;
+
+	VJoltAssert( nSingleIntersecting == nBatchedIntersecting );
+
+	Log_Msg( LOG_VJolt, "Single: %d boxes (%d hit) in %.3f ms (%.3f us each)\n", nBoxCount, nSingleIntersecting, flSingleTime * 1000.0, flSingleTime * 1e6 / nBoxCount );
+	Log_Msg( LOG_VJolt, "Batched: %d boxes (%d hit) in %.3f ms (%.3f us each)\n", nBoxCount, nBatchedIntersecting, flBatchedTime * 1000.0, flBatchedTime * 1e6 / nBoxCount );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -531,7 +1048,11 @@ namespace ivp_compat
 			}
 		}
 
-		JPH::ConvexHullShapeSettings settings{ verts.get(), nVertCount, kMaxConvexRadius, nullptr /* material */ };
+		// A convex only gets the one material. World brushes are split into ledges
+		// per material, and props use 0, which keeps the object's own.
+		const JPH::PhysicsMaterial *pMaterial = JoltPhysicsSurfaceProps::GetInstance().GetWorldMaterial( pTriangles[ 0 ].material_index );
+
+		JPH::ConvexHullShapeSettings settings{ verts.get(), nVertCount, kMaxConvexRadius, pMaterial };
 		settings.mHullTolerance = 0.0f;
 		JPH::ConvexShape *pConvexShape = ShapeSettingsToShape< JPH::ConvexShape >( settings );
 		if ( !pConvexShape )
@@ -690,6 +1211,8 @@ void JoltPhysicsCollision::VCollideLoad( vcollide_t *pOutput, int solidCount, co
 			}
 		}
 
+		CacheCollideInfo( pOutput->solids[ i ], i );
+
 		pCursor += solidSize;
 	}
 
@@ -712,7 +1235,14 @@ void JoltPhysicsCollision::VCollideUnload( vcollide_t *pVCollide )
 {
 	VCollideFreeUserData( pVCollide );
 	for ( int i = 0; i < pVCollide->solidCount; i++ )
-		delete pVCollide->solids[ i ]->ToShape();
+	{
+		if ( !pVCollide->solids[ i ] )
+			continue;
+
+		JPH::Shape *pShape = pVCollide->solids[ i ]->ToShape();
+		FreeCollideInfo( pShape );
+		delete pShape;
+	}
 
 	delete[] pVCollide->solids;
 	delete[] pVCollide->pKeyValues;
@@ -822,25 +1352,32 @@ CPhysCollide *JoltPhysicsCollision::CreateVirtualMesh( const virtualmeshparams_t
 	for ( int i = 0; i < meshList.vertexCount; ++i )
 		vertexList[i] = SourceToJolt::DistanceFloat3( meshList.pVerts[i] );
 
-	JPH::IndexedTriangleList indexedTriangleList;
-	indexedTriangleList.resize( meshList.indexCount * 2 );
+	// Add both windings to make this two-faced.
+	// Probably doesn't matter too much but matches what used to happen.
+	JPH::IndexedTriangleList frontTriangles;
+	JPH::IndexedTriangleList backTriangles;
+	frontTriangles.resize( meshList.triangleCount );
+	backTriangles.resize( meshList.triangleCount );
 
 	for ( int i = 0; i < meshList.triangleCount; ++i )
 	{
-		// Add both windings to make this two-faced.
-		// Probably doesn't matter too much but matches what used to happen.
-		indexedTriangleList[i*2+0].mIdx[0] = meshList.indices[i*3+0];
-		indexedTriangleList[i*2+0].mIdx[1] = meshList.indices[i*3+1];
-		indexedTriangleList[i*2+0].mIdx[2] = meshList.indices[i*3+2];
+		frontTriangles[i].mIdx[0] = meshList.indices[i*3+0];
+		frontTriangles[i].mIdx[1] = meshList.indices[i*3+1];
+		frontTriangles[i].mIdx[2] = meshList.indices[i*3+2];
 
-		indexedTriangleList[i*2+1].mIdx[2] = meshList.indices[i*3+0];
-		indexedTriangleList[i*2+1].mIdx[1] = meshList.indices[i*3+1];
-		indexedTriangleList[i*2+1].mIdx[0] = meshList.indices[i*3+2];
+		backTriangles[i].mIdx[2] = meshList.indices[i*3+0];
+		backTriangles[i].mIdx[1] = meshList.indices[i*3+1];
+		backTriangles[i].mIdx[0] = meshList.indices[i*3+2];
 	}
 
-	JPH::MeshShapeSettings settings( vertexList, indexedTriangleList );
+	// Every triangle here is the same surface, which is a real surface prop index
+	// rather than one from the world material table.
+	JPH::PhysicsMaterialList materials;
+	materials.push_back( JoltPhysicsSurfaceProps::GetInstance().GetSurfaceMaterial( meshList.surfacePropsIndex ) );
 
-	return ShapeSettingsToPhysCollide( settings );
+	return CacheCollideInfo( TwoSidedMeshToPhysCollide(
+		new JPH::MeshShapeSettings( vertexList, frontTriangles, materials ),
+		new JPH::MeshShapeSettings( vertexList, backTriangles, materials ) ), 0, true /* bTwoSided */ );
 }
 
 bool JoltPhysicsCollision::SupportsVirtualMesh()
@@ -88,7 +88,7 @@ public:
 //-------------------------------------------------------------------------------------------------
 
 // Josh: Suprise! This is not an app system! Just an interface...
-class JoltPhysicsCollision final : public IPhysicsCollision 
+class JoltPhysicsCollision final : public IPhysicsCollision, public IJoltPhysicsCollisionExt
 {
 public:
 	CPhysConvex		*ConvexFromVerts( Vector **pVerts, int vertCount ) override;
@@ -180,6 +180,9 @@ public:
 	void			DuplicateAndScale( vcollide_t *pOut, const vcollide_t *pIn, float flScale ) override_csgo;
 
 public:
+	// IJoltPhysicsCollisionExt
+	int				AreBoxesIntersectingCone( const Vector *pBoxAbsMins, const Vector *pBoxAbsMaxs, int nBoxCount, const truncatedcone_t &cone, bool *pOutResults ) override;
+
 	static JoltPhysicsCollision& GetInstance() { return s_PhysicsCollision; }
 
 private:
@@ -187,3 +190,10 @@ private:
 };
 
 const JPH::Shape *CreateCOMOverrideShape( const JPH::Shape* pShape, JPH::Vec3Arg comOverride );
+
+// Gets the mass center set on a collide with CollideSetMassCenter, if any.
+bool GetCollideMassCenterOverride( const JPH::Shape *pShape, JPH::Vec3 &vecMassCenter );
+
+// Call this right before dropping a reference to a shape that could be, or could hold,
+// one of our collides. If it was the last reference, the collide info goes back to be reused.
+void ReleaseCollideInfo( const JPH::Shape *pShape );
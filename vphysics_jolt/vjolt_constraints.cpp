@@ -19,9 +19,15 @@
 static ConVar vjolt_ragdoll_hinge_optimization( "vjolt_ragdoll_hinge_optimization", "1", FCVAR_REPLICATED,
 	"Optimizes ragdolls to use hinge constraints for joints with 1 degree of freedom. Additionally fixes legs going back on themselves. Currently breaks ragdolls of NPCs killed in a pose (they inherit the pose).");
 
+static ConVar vjolt_precision_group_size( "vjolt_precision_group_size", "8", FCVAR_NONE,
+	"Constraint groups with at least this many constraints get more solver steps when activated, 0 to disable." );
+
 //-------------------------------------------------------------------------------------------------
 
-JoltPhysicsConstraintGroup::JoltPhysicsConstraintGroup()
+JoltPhysicsConstraintGroup::JoltPhysicsConstraintGroup( JoltPhysicsEnvironment *pPhysicsEnvironment, const constraint_groupparams_t &params )
+	: m_ErrorParams( params )
+	, m_pPhysicsEnvironment( pPhysicsEnvironment )
+	, m_pPhysicsSystem( pPhysicsEnvironment->GetPhysicsSystem() )
 {
 }
 
@@ -33,17 +39,28 @@ JoltPhysicsConstraintGroup::~JoltPhysicsConstraintGroup()
 
 void JoltPhysicsConstraintGroup::Activate()
 {
+	// Big contraptions fall apart with the default amount of steps.
+	const int nPrecisionGroupSize = vjolt_precision_group_size.GetInt();
+	const bool bPrecision = nPrecisionGroupSize > 0 && int( m_pConstraints.size() ) >= nPrecisionGroupSize;
+
 	for ( JoltPhysicsConstraint *pConstraint : m_pConstraints )
+	{
+		if ( bPrecision )
+			m_pPhysicsEnvironment->ApplyPrecisionStepsOverride( pConstraint->GetJoltConstraint() );
+
 		pConstraint->Activate();
+	}
 }
 
 bool JoltPhysicsConstraintGroup::IsInErrorState()
 {
-	return false;
+	return m_bInErrorState;
 }
 
 void JoltPhysicsConstraintGroup::ClearErrorState()
 {
+	m_nErrorTicks = 0;
+	m_bInErrorState = false;
 }
 
 void JoltPhysicsConstraintGroup::GetErrorParams( constraint_groupparams_t *pParams )
@@ -57,8 +74,107 @@ void JoltPhysicsConstraintGroup::SetErrorParams( const constraint_groupparams_t
 	m_ErrorParams = params;
 }
 
+class SingleBodyFilter final : public JPH::BodyFilter
+{
+public:
+	SingleBodyFilter( JPH::BodyID bodyID )
+		: m_BodyID( bodyID )
+	{
+	}
+
+	bool ShouldCollide( const JPH::BodyID &inBodyID ) const override
+	{
+		return inBodyID == m_BodyID;
+	}
+
+private:
+	JPH::BodyID m_BodyID;
+};
+
 void JoltPhysicsConstraintGroup::SolvePenetration( IPhysicsObject *pObj0, IPhysicsObject *pObj1 )
 {
+	JoltPhysicsObject *pObject0 = ToJoltPhysicsObject( pObj0 );
+	JoltPhysicsObject *pObject1 = ToJoltPhysicsObject( pObj1 );
+
+	if ( !pObject0 || !pObject1 || pObject0 == pObject1 )
+		return;
+
+	const float flInvMass0 = pObject0->IsMoveable() ? pObject0->GetInvMass() : 0.0f;
+	const float flInvMass1 = pObject1->IsMoveable() ? pObject1->GetInvMass() : 0.0f;
+	const float flTotalInvMass = flInvMass0 + flInvMass1;
+	if ( flTotalInvMass <= 0.0f )
+		return;
+
+	// Only test the first object's shape against the second body, we don't care about anything else here.
+	JPH::BodyInterface &bodyInterface = m_pPhysicsSystem->GetBodyInterfaceNoLock();
+	const JPH::Mat44 queryTransform = bodyInterface.GetCenterOfMassTransform( pObject0->GetBodyID() );
+
+	JPH::CollideShapeSettings collideSettings;
+	collideSettings.mActiveEdgeMode = JPH::EActiveEdgeMode::CollideWithAll;
+
+	// ClosestHitCollisionCollector orders by negative penetration depth, so this gives us the deepest hit.
+	JPH::ClosestHitCollisionCollector< JPH::CollideShapeCollector > collector;
+	SingleBodyFilter bodyFilter( pObject1->GetBodyID() );
+
+	m_pPhysicsSystem->GetNarrowPhaseQueryNoLock().CollideShape(
+		pObject0->GetBody()->GetShape(), JPH::Vec3::sReplicate( 1.0f ), queryTransform, collideSettings, JPH::Vec3::sZero(), collector,
+		JPH::BroadPhaseLayerFilter(), JPH::ObjectLayerFilter(), bodyFilter );
+
+	if ( !collector.HadHit() || collector.mHit.mPenetrationDepth <= 0.0f )
+		return;
+
+	// The penetration axis points in the direction that moves the second body out of the first.
+	const JPH::Vec3 penetrationAxis = collector.mHit.mPenetrationAxis;
+	if ( penetrationAxis.IsNearZero() )
+		return;
+
+	const JPH::Vec3 separation = penetrationAxis.Normalized() * collector.mHit.mPenetrationDepth;
+
+	// Split the correction by inverse mass, so pinned or static objects stay put.
+	if ( flInvMass0 > 0.0f )
+	{
+		const JPH::Vec3 position = bodyInterface.GetPosition( pObject0->GetBodyID() ) - separation * ( flInvMass0 / flTotalInvMass );
+		bodyInterface.SetPosition( pObject0->GetBodyID(), position, JPH::EActivation::Activate );
+	}
+
+	if ( flInvMass1 > 0.0f )
+	{
+		const JPH::Vec3 position = bodyInterface.GetPosition( pObject1->GetBodyID() ) + separation * ( flInvMass1 / flTotalInvMass );
+		bodyInterface.SetPosition( pObject1->GetBodyID(), position, JPH::EActivation::Activate );
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsConstraintGroup::OnPostSimulate( float flDeltaTime )
+{
+	if ( m_bInErrorState || m_pConstraints.empty() )
+		return;
+
+	// Matches VPhysics, the group is in error once any of its constraints
+	// has been pulled apart by more than errorTolerance for minErrorTicks steps in a row.
+	// Compare squared distances so we only do the one pass with no sqrts.
+	const float flTolerance = SourceToJolt::Distance( m_ErrorParams.errorTolerance );
+	const float flToleranceSq = flTolerance * flTolerance;
+
+	bool bOverTolerance = false;
+	for ( JoltPhysicsConstraint *pConstraint : m_pConstraints )
+	{
+		if ( pConstraint->GetPositionErrorSq() > flToleranceSq )
+		{
+			bOverTolerance = true;
+			break;
+		}
+	}
+
+	if ( !bOverTolerance )
+	{
+		m_nErrorTicks = 0;
+		return;
+	}
+
+	if ( ++m_nErrorTicks >= m_ErrorParams.minErrorTicks )
+		m_bInErrorState = true;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -78,14 +194,14 @@ void JoltPhysicsConstraintGroup::RemoveConstraint( JoltPhysicsConstraint *pConst
 JoltPhysicsConstraint::JoltPhysicsConstraint( JoltPhysicsEnvironment *pPhysicsEnvironment, IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, constraintType_t Type, JPH::Constraint* pConstraint, void *pGameData )
 	: m_pPhysicsEnvironment( pPhysicsEnvironment )
 	, m_pPhysicsSystem( pPhysicsEnvironment->GetPhysicsSystem() )
-	, m_pObjReference( static_cast<JoltPhysicsObject*>( pReferenceObject ) )
-	, m_pObjAttached( static_cast<JoltPhysicsObject*>( pAttachedObject ) )
+	, m_pObjReference( ToJoltPhysicsObject( pReferenceObject ) )
+	, m_pObjAttached( ToJoltPhysicsObject( pAttachedObject ) )
 	, m_ConstraintType( Type )
 	, m_pConstraint( pConstraint )
 	, m_pGameData( pGameData )
 {
-	m_pObjReference->AddDestroyedListener( this );
-	m_pObjAttached->AddDestroyedListener( this );
+	m_pObjReference->AddConstraint( this );
+	m_pObjAttached->AddConstraint( this );
 }
 
 JoltPhysicsConstraint::~JoltPhysicsConstraint()
@@ -321,6 +437,7 @@ bool JoltPhysicsConstraint::InitialiseHingeFromRagdoll( IPhysicsConstraintGroup*
 	}
 
 	InitialiseHinge( pGroup, hinge );
+	m_pPhysicsEnvironment->ApplyPrecisionStepsOverride( m_pConstraint );
 
 	return true;
 }
@@ -337,6 +454,7 @@ void JoltPhysicsConstraint::InitialiseRagdoll( IPhysicsConstraintGroup *pGroup,
 
 	SetGroup( pGroup );
 	m_ConstraintType = CONSTRAINT_RAGDOLL;
+	m_bPositionLocked = !ragdoll.onlyAngularLimits;
 
 	JPH::Body *refBody = m_pObjReference->GetBody();
 	JPH::Body *attBody = m_pObjAttached->GetBody();
@@ -415,6 +533,7 @@ void JoltPhysicsConstraint::InitialiseRagdoll( IPhysicsConstraintGroup *pGroup,
 
 	m_pConstraint = settings.Create( *refBody, *attBody );
 	m_pConstraint->SetEnabled( !pGroup && ragdoll.constraint.isActive );
+	m_pPhysicsEnvironment->ApplyPrecisionStepsOverride( m_pConstraint );
 
 	m_pPhysicsSystem->AddConstraint( m_pConstraint );
 }
@@ -434,6 +553,7 @@ void JoltPhysicsConstraint::InitialiseHinge( IPhysicsConstraintGroup *pGroup, co
 {
 	SetGroup( pGroup );
 	m_ConstraintType = CONSTRAINT_HINGE;
+	m_bPositionLocked = true;
 
 	// Get our bodies
 	JPH::Body *refBody = m_pObjReference->GetBody();
@@ -510,6 +630,7 @@ void JoltPhysicsConstraint::InitialiseBallsocket( IPhysicsConstraintGroup *pGrou
 {
 	SetGroup( pGroup );
 	m_ConstraintType = CONSTRAINT_BALLSOCKET;
+	m_bPositionLocked = true;
 
 	// Get our bodies
 	JPH::Body *refBody = m_pObjReference->GetBody();
@@ -534,6 +655,7 @@ void JoltPhysicsConstraint::InitialiseFixed( IPhysicsConstraintGroup *pGroup, co
 {
 	SetGroup( pGroup );
 	m_ConstraintType = CONSTRAINT_FIXED;
+	m_bPositionLocked = true;
 
 	// Get our bodies
 	JPH::Body *refBody = m_pObjReference->GetBody();
@@ -547,6 +669,40 @@ void JoltPhysicsConstraint::InitialiseFixed( IPhysicsConstraintGroup *pGroup, co
 	m_pPhysicsSystem->AddConstraint( m_pConstraint );
 }
 
+//-------------------------------------------------------------------------------------------------
+// Pulley
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsConstraint::InitialisePulley( IPhysicsConstraintGroup *pGroup, const constraint_pulleyparams_t &pulley )
+{
+	SetGroup( pGroup );
+	m_ConstraintType = CONSTRAINT_PULLEY;
+
+	// Get our bodies
+	JPH::Body *refBody = m_pObjReference->GetBody();
+	JPH::Body *attBody = m_pObjAttached->GetBody();
+
+	JPH::PulleyConstraintSettings settings;
+	settings.mSpace = JPH::EConstraintSpace::LocalToBodyCOM;
+	settings.mBodyPoint1 = SourceToJolt::Distance( pulley.objectPosition[0] ) - refBody->GetShape()->GetCenterOfMass();
+	settings.mBodyPoint2 = SourceToJolt::Distance( pulley.objectPosition[1] ) - attBody->GetShape()->GetCenterOfMass();
+
+	// The pulley points are always in world space.
+	settings.mFixedPoint1 = SourceToJolt::Distance( pulley.pulleyPosition[0] );
+	settings.mFixedPoint2 = SourceToJolt::Distance( pulley.pulleyPosition[1] );
+
+	// Source's total length already has the gearing applied to the attached side,
+	// which is the same as Jolt's Length1 + Ratio * Length2.
+	settings.mRatio = pulley.gearRatio;
+	settings.mMaxLength = SourceToJolt::Distance( pulley.totalLength );
+	settings.mMinLength = pulley.isRigid ? settings.mMaxLength : 0.0f;
+
+	m_pConstraint = settings.Create( *refBody, *attBody );
+	m_pConstraint->SetEnabled( !pGroup && pulley.constraint.isActive );
+
+	m_pPhysicsSystem->AddConstraint( m_pConstraint );
+}
+
 //-------------------------------------------------------------------------------------------------
 // Length
 //-------------------------------------------------------------------------------------------------
@@ -593,6 +749,28 @@ void JoltPhysicsConstraint::SaveConstraintSettings( JPH::StateRecorder &recorder
 
 //-------------------------------------------------------------------------------------------------
 
+float JoltPhysicsConstraint::GetPositionErrorSq() const
+{
+	if ( !m_bPositionLocked || !m_pConstraint || !m_pConstraint->GetEnabled() )
+		return 0.0f;
+
+	VJoltAssert( m_pConstraint->GetType() == JPH::EConstraintType::TwoBodyConstraint );
+	const JPH::TwoBodyConstraint *pConstraint = static_cast< const JPH::TwoBodyConstraint * >( m_pConstraint.GetPtr() );
+
+	const JPH::Body *pBody1 = pConstraint->GetBody1();
+	const JPH::Body *pBody2 = pConstraint->GetBody2();
+
+	// Nothing can have changed if both sides are asleep.
+	if ( !pBody1->IsActive() && !pBody2->IsActive() )
+		return 0.0f;
+
+	const JPH::Vec3 anchor1 = pBody1->GetCenterOfMassTransform() * pConstraint->GetConstraintToBody1Matrix().GetTranslation();
+	const JPH::Vec3 anchor2 = pBody2->GetCenterOfMassTransform() * pConstraint->GetConstraintToBody2Matrix().GetTranslation();
+	return ( anchor2 - anchor1 ).LengthSq();
+}
+
+//-------------------------------------------------------------------------------------------------
+
 void JoltPhysicsConstraint::SetGroup( IPhysicsConstraintGroup *pGroup )
 {
 	if ( m_pGroup )
@@ -606,12 +784,12 @@ void JoltPhysicsConstraint::DestroyConstraint()
 {
 	if ( m_pObjAttached )
 	{
-		m_pObjAttached->RemoveDestroyedListener( this );
+		m_pObjAttached->RemoveConstraint( this );
 		m_pObjAttached = nullptr;
 	}
 	if ( m_pObjReference )
 	{
-		m_pObjReference->RemoveDestroyedListener( this );
+		m_pObjReference->RemoveConstraint( this );
 		m_pObjReference = nullptr;
 	}
 
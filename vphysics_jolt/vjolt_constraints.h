@@ -23,10 +23,10 @@ enum constraintType_t
 class JoltPhysicsConstraint;
 class JoltPhysicsEnvironment;
 
-class JoltPhysicsConstraintGroup final : public IPhysicsConstraintGroup
+class JoltPhysicsConstraintGroup final : public IPhysicsConstraintGroup, public IJoltPhysicsController
 {
 public:
-	JoltPhysicsConstraintGroup();
+	JoltPhysicsConstraintGroup( JoltPhysicsEnvironment *pPhysicsEnvironment, const constraint_groupparams_t &params );
 	~JoltPhysicsConstraintGroup() override;
 
 	void Activate() override;
@@ -36,12 +36,21 @@ public:
 	void SetErrorParams( const constraint_groupparams_t &params ) override;
 	void SolvePenetration( IPhysicsObject *pObj0, IPhysicsObject *pObj1 ) override;
 
+	// IJoltPhysicsController
+	void OnPostSimulate( float flDeltaTime ) override;
+
 	void AddConstraint( JoltPhysicsConstraint *pConstraint );
 	void RemoveConstraint( JoltPhysicsConstraint *pConstraint );
 
 private:
 	std::vector< JoltPhysicsConstraint * >	m_pConstraints;
 	constraint_groupparams_t				m_ErrorParams = {};
+
+	int										m_nErrorTicks = 0;
+	bool									m_bInErrorState = false;
+
+	JoltPhysicsEnvironment					*m_pPhysicsEnvironment = nullptr;
+	JPH::PhysicsSystem						*m_pPhysicsSystem = nullptr;
 };
 
 class JoltPhysicsConstraint final : public IPhysicsConstraint, public IJoltObjectDestroyedListener
@@ -78,10 +87,17 @@ public:
 	void InitialiseSliding( IPhysicsConstraintGroup *pGroup, const constraint_slidingparams_t &sliding );
 	void InitialiseBallsocket( IPhysicsConstraintGroup *pGroup, const constraint_ballsocketparams_t &ballsocket );
 	void InitialiseFixed( IPhysicsConstraintGroup *pGroup, const constraint_fixedparams_t &fixed );
+	void InitialisePulley( IPhysicsConstraintGroup *pGroup, const constraint_pulleyparams_t &pulley );
 	void InitialiseLength( IPhysicsConstraintGroup *pGroup, const constraint_lengthparams_t &length );
 
 	void SaveConstraintSettings( JPH::StateRecorder &recorder );
 
+	// Returns the squared distance in Jolt units between the constraint's anchors on its two bodies,
+	// or 0 if the constraint does not lock position or neither body is awake.
+	float GetPositionErrorSq() const;
+
+	JPH::Constraint *GetJoltConstraint() const { return m_pConstraint; }
+
 private:
 
 	void SetGroup( IPhysicsConstraintGroup *pGroup );
@@ -92,6 +108,7 @@ private:
 	JoltPhysicsObject			*m_pObjAttached = nullptr;
 	JPH::Ref< JPH::Constraint > m_pConstraint;
 	constraintType_t			m_ConstraintType = CONSTRAINT_UNKNOWN;
+	bool						m_bPositionLocked = false;
 
 	JoltPhysicsConstraintGroup	*m_pGroup = nullptr;
 
@@ -28,10 +28,10 @@ void JoltPhysicsMotionController::SetEventHandler( IMotionEvent *pHandler )
 
 void JoltPhysicsMotionController::AttachObject( IPhysicsObject *pObject, bool bCheckIfAlreadyAttached )
 {
-	if ( !pObject || pObject->IsStatic() )
+	JoltPhysicsObject *pPhysicsObject = ToJoltPhysicsObject( pObject );
+	if ( !pPhysicsObject || pPhysicsObject->IsStatic() )
 		return;
 
-	JoltPhysicsObject *pPhysicsObject = static_cast< JoltPhysicsObject * >( pObject );
 	if ( bCheckIfAlreadyAttached && VectorContains( m_pObjects, pPhysicsObject ) )
 		return;
 
@@ -41,10 +41,10 @@ void JoltPhysicsMotionController::AttachObject( IPhysicsObject *pObject, bool bC
 
 void JoltPhysicsMotionController::DetachObject( IPhysicsObject *pObject )
 {
-	if ( !pObject )
+	JoltPhysicsObject *pPhysicsObject = ToJoltPhysicsObject( pObject );
+	if ( !pPhysicsObject )
 		return;
 
-	JoltPhysicsObject *pPhysicsObject = static_cast< JoltPhysicsObject * >( pObject );
 	Erase( m_pObjects, pPhysicsObject );
 	pPhysicsObject->RemoveDestroyedListener( this );
 }
@@ -84,8 +84,7 @@ void JoltPhysicsMotionController::SetPriority( priority_t priority )
 
 void JoltPhysicsMotionController::OnJoltPhysicsObjectDestroyed( JoltPhysicsObject *pObject )
 {
-	JoltPhysicsObject *pPhysicsObject = static_cast< JoltPhysicsObject * >( pObject );
-	Erase( m_pObjects, pPhysicsObject );
+	Erase( m_pObjects, pObject );
 }
 
 void JoltPhysicsMotionController::OnPreSimulate( float flDeltaTime )
@@ -45,7 +45,7 @@ void JoltPhysicsPlayerController::Update( const Vector &position, const Vector &
 	// Bogus assertion: onground can be true and ground can be null when touching the world. That is okay
 	//VJoltAssert( ( onground && ground ) || ( !onground && !ground ) );
 
-	SetGround( static_cast<JoltPhysicsObject *>( ground ) );
+	SetGround( ToJoltPhysicsObject( ground ) );
 }
 
 void JoltPhysicsPlayerController::SetEventHandler( IPhysicsPlayerControllerEvent *handler )
@@ -70,7 +70,14 @@ void JoltPhysicsPlayerController::MaxSpeed( const Vector &velocity )
 
 void JoltPhysicsPlayerController::SetObject( IPhysicsObject *pObject )
 {
-	SetObjectInternal( static_cast<JoltPhysicsObject *>( pObject ) );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( pObject && !pJoltObject )
+	{
+		Log_Warning( LOG_VJolt, "Tried to give a player controller a vehicle wheel.\n" );
+		return;
+	}
+
+	SetObjectInternal( pJoltObject );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -257,11 +264,14 @@ private:
 	JoltPhysicsObject	*m_pSelfObject;
 };
 
-class NormalWeightedCollector : public JPH::CollideShapeCollector
+// Collects everything the player is touching in one pass so that the ground push
+// in OnPreSimulate and GetContactState can share the same query.
+class PlayerContactCollector : public JPH::CollideShapeCollector
 {
 public:
-	NormalWeightedCollector( JPH::PhysicsSystem *pPhysicsSystem )
+	PlayerContactCollector( JPH::PhysicsSystem *pPhysicsSystem, std::vector< JPH::BodyID > &contactBodies )
 		: m_pPhysicsSystem( pPhysicsSystem )
+		, m_ContactBodies( contactBodies )
 	{
 	}
 
@@ -269,89 +279,90 @@ public:
 	{
 		JPH::CollideShapeCollector::Reset();
 
-		m_bHadHit = false;
+		m_ContactBodies.clear();
+		m_GroundBodyID = JPH::BodyID();
 		m_flLowestNormalZ = 1.0f;
 	}
 
 	void AddHit( const JPH::CollideShapeResult &inResult ) override
 	{
-		JPH::BodyLockRead lock( m_pPhysicsSystem->GetBodyLockInterfaceNoLock(), inResult.mBodyID2 );
-		const JPH::Body &body = lock.GetBody();
-
-		JPH::Vec3 normal = body.GetWorldSpaceSurfaceNormal( inResult.mSubShapeID2, inResult.mContactPointOn2 );
-		m_flLowestNormalZ = Min( m_flLowestNormalZ, -normal.GetZ() );
+		// We are inside of a query against the narrow phase, nothing can add or remove bodies
+		// so skip the body lock.
+		const JPH::Body *pBody = m_pPhysicsSystem->GetBodyLockInterfaceNoLock().TryGetBody( inResult.mBodyID2 );
+		if ( !pBody )
+			return;
+
+		JPH::Vec3 normal = pBody->GetWorldSpaceSurfaceNormal( inResult.mSubShapeID2, inResult.mContactPointOn2 );
+		if ( -normal.GetZ() < m_flLowestNormalZ )
+		{
+			m_flLowestNormalZ = -normal.GetZ();
+			m_GroundBodyID = inResult.mBodyID2;
+		}
 
-		m_Hit = inResult;
-		m_bHadHit = true;
+		// Compound shapes give us a hit per sub-shape, only keep each body once.
+		if ( std::find( m_ContactBodies.begin(), m_ContactBodies.end(), inResult.mBodyID2 ) == m_ContactBodies.end() )
+			m_ContactBodies.push_back( inResult.mBodyID2 );
 	}
 
 	inline bool HadHit() const
 	{
-		return m_bHadHit;
+		return !m_GroundBodyID.IsInvalid();
 	}
 
 	float m_flLowestNormalZ = 1.0f;
-
-	JPH::CollideShapeCollector::ResultType m_Hit;
+	JPH::BodyID m_GroundBodyID;
 
 private:
-	JPH::PhysicsSystem		*m_pPhysicsSystem;
-	bool					m_bHadHit = false;
+	JPH::PhysicsSystem			*m_pPhysicsSystem;
+	std::vector< JPH::BodyID >	&m_ContactBodies;
 };
 
+static void CollectPlayerContacts( JoltPhysicsObject *pObject, PlayerContactCollector &collector )
+{
+	SourceHitFilter<true> filter( pObject->GetEnvironment()->GetPhysicsSystem(), pObject );
+	collector.Reset();
+	CheckCollision( pObject, collector, filter );
+}
+
 uint32 JoltPhysicsPlayerController::GetContactState( uint16 nGameFlags )
 {
 	// This does not seem to affect much, we should aspire to have our physics be as 1:1 to brush collisions as possible anyway
 #ifdef GAME_PORTAL2_OR_NEWER
-	if ( !m_pObject->IsCollisionEnabled() )
+	if ( !m_pObject || !m_pObject->IsCollisionEnabled() )
 		return 0;
 
-	// Collector that finds the hit with the normal that is the most 'up'
-	class ContactStateCollector : public JPH::CollideShapeCollector
-	{
-	public:
-		ContactStateCollector( JPH::PhysicsSystem *pPhysicsSystem, JoltPhysicsObject *pPlayerObject, uint16 nGameFlags )
-			: m_pPhysicsSystem( pPhysicsSystem )
-			, m_pPlayerObject( pPlayerObject )
-			, m_nGameFlags( nGameFlags )
-		{
-		}
-
-		void Reset() override
-		{
-			JPH::CollideShapeCollector::Reset();
-
-			m_nFlagsOut = 0;
-		}
-
-		void AddHit( const JPH::CollideShapeResult &inResult ) override
-		{
-			JPH::BodyLockRead lock( m_pPhysicsSystem->GetBodyLockInterfaceNoLock(), inResult.mBodyID2 );
-			const JPH::Body &body = lock.GetBody();
+	JPH::PhysicsSystem *pSystem = m_pObject->GetEnvironment()->GetPhysicsSystem();
 
-			JoltPhysicsObject *pObject = reinterpret_cast<JoltPhysicsObject *>( body.GetUserData() );
+	// Use the contacts we found in OnPreSimulate rather than doing the whole
+	// collide shape query again. If we haven't simulated since our object
+	// changed, we have nothing yet, so go and find them now.
+	if ( !m_bContactBodiesValid )
+	{
+		PlayerContactCollector collector( pSystem, m_ContactBodies );
+		CollectPlayerContacts( m_pObject, collector );
+		m_bContactBodiesValid = true;
+	}
 
-			if ( !pObject->IsControlledByGame() )
-				m_nFlagsOut |= PLAYER_CONTACT_PHYSICS;
+	// The bodies could have gone away since then, so look them up again by ID.
+	const JPH::BodyLockInterfaceNoLock &bodyLockInterface = pSystem->GetBodyLockInterfaceNoLock();
 
-			if ( pObject->GetGameFlags() & m_nGameFlags )
-				m_nFlagsOut |= PLAYER_CONTACT_GAMEOBJECT;
-		}
+	uint32 nFlags = 0;
+	for ( const JPH::BodyID &bodyID : m_ContactBodies )
+	{
+		const JPH::Body *pBody = bodyLockInterface.TryGetBody( bodyID );
+		if ( !pBody )
+			continue;
 
-		uint32					m_nFlagsOut = 0;
+		JoltPhysicsObject *pObject = reinterpret_cast<JoltPhysicsObject *>( pBody->GetUserData() );
 
-	private:
-		JPH::PhysicsSystem		*m_pPhysicsSystem;
-		JoltPhysicsObject		*m_pPlayerObject;
-		uint16					m_nGameFlags;
-	};
+		if ( !pObject->IsControlledByGame() )
+			nFlags |= PLAYER_CONTACT_PHYSICS;
 
-	JPH::PhysicsSystem *pSystem = m_pObject->GetEnvironment()->GetPhysicsSystem();
-	ContactStateCollector collector( pSystem, m_pObject, nGameFlags );
-	SourceHitFilter<true> filter( pSystem, m_pObject );
-	CheckCollision( m_pObject, collector, filter );
+		if ( pObject->GetGameFlags() & nGameFlags )
+			nFlags |= PLAYER_CONTACT_GAMEOBJECT;
+	}
 
-	return collector.m_nFlagsOut;
+	return nFlags;
 #else
 	return 0;
 #endif
@@ -399,15 +410,15 @@ void JoltPhysicsPlayerController::OnPreSimulate( float flDeltaTime )
 	JPH::PhysicsSystem *pPhysicsSystem = m_pObject->GetEnvironment()->GetPhysicsSystem();
 	JPH::BodyInterface &bodyInterface = pPhysicsSystem->GetBodyInterfaceNoLock();
 
-	// Project ourselves towards our velocity
-	NormalWeightedCollector collector( pPhysicsSystem );
-	SourceHitFilter<true> filter( pPhysicsSystem, m_pObject );
-	CheckCollision( m_pObject, collector, filter );
-	
+	// Find everything we are touching, this is also what GetContactState reports back
+	PlayerContactCollector collector( pPhysicsSystem, m_ContactBodies );
+	CollectPlayerContacts( m_pObject, collector );
+	m_bContactBodiesValid = true;
+
 	// Source typically uses -0.7 for ground.
 	if ( collector.HadHit() && collector.m_flLowestNormalZ < -0.7f )
 	{
-		JPH::BodyID otherID = collector.m_Hit.mBodyID2;
+		JPH::BodyID otherID = collector.m_GroundBodyID;
 
 		//bodyInterface.AddImpulse( otherID, m_pObject->GetMass() * m_targetVelocity * flDeltaTime, m_pObject->GetBody()->GetPosition() );
 		bodyInterface.AddImpulse( otherID, m_pObject->GetMass() * pPhysicsSystem->GetGravity() * flDeltaTime, m_pObject->GetBody()->GetPosition());
@@ -455,6 +466,10 @@ void JoltPhysicsPlayerController::SetObjectInternal( JoltPhysicsObject *pObject
 	// Set our new object
 	m_pObject = pObject;
 
+	// Whatever we were touching belonged to the last object
+	m_ContactBodies.clear();
+	m_bContactBodiesValid = false;
+
 	// Adjust the new object
 	if ( m_pObject )
 	{
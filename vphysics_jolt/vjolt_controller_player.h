@@ -67,4 +67,8 @@ private:
 	float m_flPushableSpeedLimit = 1e4f;
 
 	uint16 m_savedMaterialIndex = 0;
+
+	// Bodies we were touching as of the last OnPreSimulate
+	std::vector< JPH::BodyID > m_ContactBodies;
+	bool m_bContactBodiesValid = false;
 };
@@ -3,6 +3,8 @@
 
 #include "vjolt_layers.h"
 
+#include "vjolt_vehicle_wheel.h"
+
 #include "vjolt_controller_vehicle.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
@@ -15,6 +17,13 @@ static ConVar vjolt_vehicle_wheel_debug( "vjolt_vehicle_wheel_debug", "0", FCVAR
 static ConVar vjolt_vehicle_throttle_opposition_limit( "vjolt_vehicle_throttle_opposition_limit", "5", FCVAR_NONE,
 	"Below what speed should we be attempting to drive/climb with handbrake on to avoid falling down." );
 
+static ConVar vjolt_vehicle_lod( "vjolt_vehicle_lod", "1", FCVAR_NONE,
+	"Step unoccupied vehicles far away from any player at a reduced rate, and skip stepping sleeping vehicles entirely." );
+static ConVar vjolt_vehicle_lod_distance( "vjolt_vehicle_lod_distance", "2048", FCVAR_NONE,
+	"Distance from the nearest player beyond which unoccupied vehicles are stepped at a reduced rate." );
+static ConVar vjolt_vehicle_lod_interval( "vjolt_vehicle_lod_interval", "4", FCVAR_NONE,
+	"How many physics steps a reduced rate vehicle waits between updates.", true, 1, true, 16 );
+
 //------------------------------------------------------------------------------------------------
 
 static const JPH::Vec3 VehicleUpVector		= JPH::Vec3( 0, 0, 1 );
@@ -41,6 +50,15 @@ JPH::Ref< JPH::VehicleCollisionTester > CreateVehicleCollisionTester( unsigned i
 		[[ fallthrough ]];
 	case VEHICLE_TYPE_CAR_WHEELS:
 		return new JPH::VehicleCollisionTesterCastSphere( Layers::MOVING, LargestWheelRadius, VehicleUpVector );
+
+	// The raycast vehicle types are raycast in regular VPhysics too, so a ray
+	// is both the correct behaviour and a lot cheaper than sweeping a sphere.
+	// The airboat's pontoons don't need anything special here, the hull
+	// gets its buoyancy from the fluid controller like any other object.
+	case VEHICLE_TYPE_CAR_RAYCAST:
+	case VEHICLE_TYPE_JETSKI_RAYCAST:
+	case VEHICLE_TYPE_AIRBOAT_RAYCAST:
+		return new JPH::VehicleCollisionTesterRay( Layers::MOVING, VehicleUpVector );
 	}
 }
 
@@ -64,8 +82,9 @@ JoltPhysicsVehicleController::JoltPhysicsVehicleController( JoltPhysicsEnvironme
 
 	m_pCarBodyObject->AddDestroyedListener( this );
 	m_VehicleConstraint = new JPH::VehicleConstraint( *m_pCarBodyObject->GetBody(), vehicle );
+	m_pEnvironment->ApplyPrecisionStepsOverride( m_VehicleConstraint );
 	m_pPhysicsSystem->AddConstraint( m_VehicleConstraint );
-	m_pPhysicsSystem->AddStepListener( m_VehicleConstraint );
+	m_pPhysicsSystem->AddStepListener( &m_StepListener );
 }
 
 JoltPhysicsVehicleController::~JoltPhysicsVehicleController()
@@ -73,7 +92,7 @@ JoltPhysicsVehicleController::~JoltPhysicsVehicleController()
 	DetachObject();
 
 	for ( auto &wheel : m_Wheels )
-		m_pEnvironment->DestroyObject( wheel.pObject );
+		delete wheel.pObject;
 	m_Wheels.clear();
 }
 
@@ -163,6 +182,8 @@ void JoltPhysicsVehicleController::SetWheelFriction( int wheelIndex, float frict
 
 void JoltPhysicsVehicleController::OnVehicleEnter()
 {
+	m_bOccupied = true;
+
 	// Undo any damping we may have set to slow the boat when
 	// we got out.
 	if ( m_VehicleType == VEHICLE_TYPE_AIRBOAT_RAYCAST )
@@ -175,6 +196,8 @@ void JoltPhysicsVehicleController::OnVehicleEnter()
 
 void JoltPhysicsVehicleController::OnVehicleExit()
 {
+	m_bOccupied = false;
+
 	// If we are an airboat, set a bunch of damping to slow us down.
 	if ( m_VehicleType == VEHICLE_TYPE_AIRBOAT_RAYCAST )
 	{
@@ -216,6 +239,35 @@ float JoltPhysicsVehicleController::GetSpeed()
 	return orientation.Dot( m_pCarBodyObject->GetVelocity() );
 }
 
+bool JoltPhysicsVehicleController::GetWheelWorldTransform( int nWheel, JPH::Mat44 &transform ) const
+{
+	if ( !m_pCarBodyObject || nWheel < 0 || nWheel >= int( m_Wheels.size() ) )
+		return false;
+
+	// The cylinder we draw is aligned with Y so we specify that as rotational axis.
+	// This carries a translation, so callers must take GetRotation() before GetQuaternion().
+	transform = m_VehicleConstraint->GetWheelWorldTransform( nWheel, JPH::Vec3( 1, 0, 0 ), JPH::Vec3( 0, 0, 1 ) );
+	return true;
+}
+
+float JoltPhysicsVehicleController::GetWheelAngularVelocity( int nWheel ) const
+{
+	if ( !m_pCarBodyObject || nWheel < 0 || nWheel >= int( m_Wheels.size() ) )
+		return 0.0f;
+
+	return m_VehicleConstraint->GetWheels()[ nWheel ]->GetAngularVelocity();
+}
+
+void JoltPhysicsVehicleController::GetActiveWheels( std::vector< IPhysicsObject * > &wheels, bool bIncludeAsleep ) const
+{
+	// Report our wheels as active whenever the car is, so the game bothers to do pose positions.
+	if ( !m_pCarBodyObject || ( !bIncludeAsleep && !m_pCarBodyObject->GetBody()->IsActive() ) )
+		return;
+
+	for ( const JoltPhysicsWheel &wheel : m_Wheels )
+		wheels.push_back( wheel.pObject );
+}
+
 //------------------------------------------------------------------------------------------------
 
 void JoltPhysicsVehicleController::HandleBoostKey()
@@ -245,9 +297,11 @@ void JoltPhysicsVehicleController::OnPreSimulate( float flDeltaTime )
 {
 	JPH::BodyInterface &bodyInterface = m_pPhysicsSystem->GetBodyInterfaceNoLock();
 	// With any user input, assure that the car is active
-	if ( m_ControlParams.steering != 0.0f || m_ControlParams.throttle != 0.0f || m_ControlParams.brake != 0.0f || m_ControlParams.handbrake )
+	if ( HasDriverInput() )
 		bodyInterface.ActivateBody( m_pCarBodyObject->GetBodyID() );
 
+	UpdateLOD();
+
 	bool bHandbrake = m_ControlParams.handbrake;
 
 	// Don't throttle when holding handbrake (like Source)
@@ -297,34 +351,91 @@ void JoltPhysicsVehicleController::OnPreSimulate( float flDeltaTime )
 
 //------------------------------------------------------------------------------------------------
 
-void JoltPhysicsVehicleController::OnPostSimulate( float flDeltaTime )
+bool JoltPhysicsVehicleController::HasDriverInput() const
 {
-	// Draw our wheels (this needs to be done in the pre update since we draw the bodies too in the state before the step)
+	return m_ControlParams.steering != 0.0f || m_ControlParams.throttle != 0.0f || m_ControlParams.brake != 0.0f || m_ControlParams.handbrake ||
+		m_InternalState.BoosterRemainingTime != 0.0f;
+}
+
+void JoltPhysicsVehicleController::UpdateLOD()
+{
+	m_nLODInterval = 1;
+
+	if ( !vjolt_vehicle_lod.GetBool() || m_bOccupied || HasDriverInput() )
+		return;
+
+	const float flLODDistance = SourceToJolt::Distance( vjolt_vehicle_lod_distance.GetFloat() );
+	if ( m_pEnvironment->GetNearestPlayerDistanceSq( m_pCarBodyObject->GetBody()->GetPosition() ) > flLODDistance * flLODDistance )
+		m_nLODInterval = vjolt_vehicle_lod_interval.GetInt();
+}
 
+bool JoltPhysicsVehicleController::HasValidWheelContacts() const
+{
+	// Once the car is moving, the wheels need casting again to find out what they are on.
+	const JPH::Body *pCarBody = m_pCarBodyObject->GetBody();
+	if ( !pCarBody->GetLinearVelocity().IsNearZero( kLODRestingSpeedSq ) || !pCarBody->GetAngularVelocity().IsNearZero( kLODRestingSpeedSq ) )
+		return false;
+
+	// Anything that can move under the wheels could make the contacts stale, or be gone entirely.
+	const JPH::BodyLockInterfaceNoLock &bodyLockInterface = m_pPhysicsSystem->GetBodyLockInterfaceNoLock();
+	for ( const JPH::Wheel *pWheel : m_VehicleConstraint->GetWheels() )
+	{
+		if ( !pWheel->HasContact() )
+			continue;
+
+		const JPH::Body *pContactBody = bodyLockInterface.TryGetBody( pWheel->GetContactBodyID() );
+		if ( !pContactBody || !pContactBody->IsStatic() )
+			return false;
+	}
+
+	return true;
+}
+
+void JoltPhysicsVehicleController::OnVehicleStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem )
+{
+	// The constraint's OnStep is what works out whether it is active, and what the wheels are
+	// touching, which island building relies on. A sleeping car always gets stepped so the
+	// constraint goes inactive along with it, and anything touching the wheels can wake it.
+	//
+	// Far away vehicles that are sitting still on the world only get stepped every few steps,
+	// with all the time since the last one so the engine and wheels still spin up and down
+	// at the same speed. If anything changes under them they get stepped straight away.
+	m_flLODSkippedTime += flDeltaTime;
+	const bool bSkip = vjolt_vehicle_lod.GetBool() && m_pCarBodyObject->GetBody()->IsActive() &&
+		++m_nLODSkippedSteps < m_nLODInterval && HasValidWheelContacts();
+	if ( bSkip )
+		return;
+
+	const float flStepTime = m_flLODSkippedTime;
+	m_nLODSkippedSteps = 0;
+	m_flLODSkippedTime = 0.0f;
+
+	// VehicleConstraint::OnStep is private, go through the listener interface.
+	JPH::PhysicsStepListener *pVehicleListener = m_VehicleConstraint;
+	pVehicleListener->OnStep( flStepTime, physicsSystem );
+}
+
+void JoltVehicleStepListener::OnStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem )
+{
+	m_pController->OnVehicleStep( flDeltaTime, physicsSystem );
+}
+
+//------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleController::OnPostSimulate( float flDeltaTime )
+{
 	float flSteeringAngle = 0.0f;
 	m_OperatingParams.wheelsInContact = 0;
 	m_OperatingParams.wheelsNotInContact = 0;
 	for ( int w = 0; w < GetWheelCount(); w++ )
 	{
-		const JPH::WheelSettings *settings = m_VehicleConstraint->GetWheels()[w]->GetSettings();
-		// The cyclinder we draw is aligned with Y so we specify that as rotational axis
-		JPH::Mat44 wheelTransform = m_VehicleConstraint->GetWheelWorldTransform( w, JPH::Vec3( 1, 0, 0 ),  JPH::Vec3( 0, 0, 1 ) );
-		
 		// Find our greatest steering angle.
 		float flWheelSteeringAngle = JoltToSource::Angle( m_VehicleConstraint->GetWheels()[w]->GetSteerAngle() );
 		if ( fabsf( flWheelSteeringAngle ) > fabsf( flSteeringAngle ) )
 			flSteeringAngle = flWheelSteeringAngle;
 
-		Vector newPos = JoltToSource::Distance( wheelTransform.GetTranslation() );
-		// TODO(Josh): This triggers JPH_ASSERT(mCol[3] == Vec4(0, 0, 0, 1));
-		// what to do about that?..
-		// We just want the local rotation, and this seems to work (?)
-		QAngle newQuat = JoltToSource::Angle( wheelTransform.GetQuaternion() );
-		m_Wheels[ w ].pObject->EnableCollisions( false );
-		// Set dummy wheel object pos/angles so the game code can update pose positions for wheels.
-		m_Wheels[ w ].pObject->SetPosition( newPos, newQuat, true );
-		// Wake it up so that the game bothers to do pose positions.
-		m_Wheels[ w ].pObject->Wake();
+		// The wheel objects work out where they are from the constraint when the game
+		// asks, so there is nothing to push to them here anymore.
 
 		if ( m_VehicleConstraint->GetWheels()[w]->HasContact() )
 			m_OperatingParams.wheelsInContact++;
@@ -334,13 +445,18 @@ void JoltPhysicsVehicleController::OnPostSimulate( float flDeltaTime )
 		IVJoltDebugOverlay *pDebugOverlay = JoltPhysicsInterface::GetInstance().GetDebugOverlay();
 		if ( vjolt_vehicle_wheel_debug.GetBool() && pDebugOverlay )
 		{
+			const JPH::WheelSettings *settings = m_VehicleConstraint->GetWheels()[w]->GetSettings();
+
+			JPH::Mat44 wheelTransform;
+			GetWheelWorldTransform( w, wheelTransform );
+
 			const Vector vecWheelPos = JoltToSource::Distance( wheelTransform.GetTranslation() );
 			const Vector vecWheelSize = JoltToSource::Distance( JPH::Vec3( settings->mWidth / 2.0f, settings->mRadius, settings->mRadius ) );
 
 			pDebugOverlay->AddBoxOverlay(
 				vecWheelPos,
 				-vecWheelSize, vecWheelSize,
-				newQuat,
+				JoltToSource::Angle( wheelTransform.GetRotation().GetQuaternion() ),
 				255, 0, 255, 100,
 				-1.0f );
 		}
@@ -363,15 +479,11 @@ void JoltPhysicsVehicleController::CreateWheel( JPH::VehicleConstraintSettings &
 	const Vector wheelPositionLocal = axle.offset +
 		( ( wheelIdx % 2 == 1 ) ? axle.wheelOffset : -axle.wheelOffset );
 
-	Vector wheelPositionWorld;
-	VectorTransform( wheelPositionLocal, bodyMatrix, wheelPositionWorld );
-
 	// Josh: Good enough heuristic.
 	const float wheelRadius = axle.wheels.radius;
 	const float wheelWidth = wheelRadius / 2.0f;
 
 	// Josh: Area of a cylinder = π.h.r^2
-	// Using radius in terms of Source units as we pass this to CreateSphereObject.
 	const float wheelVolume = M_PI * wheelWidth * Cube( wheelRadius );
 
 	{
@@ -385,19 +497,12 @@ void JoltPhysicsVehicleController::CreateWheel( JPH::VehicleConstraintSettings &
 			.pGameData	= m_pCarBodyObject->GetGameData(),
 			.volume		= wheelVolume,
 		};
-		IPhysicsObject *pWheelObject = m_pEnvironment->CreateSphereObject(
-			wheelRadius, axle.wheels.materialIndex,
-			wheelPositionWorld, QAngle(),
-			&wheelParams, false );
-
-		JoltPhysicsObject *pJoltWheelObject = static_cast< JoltPhysicsObject * >( pWheelObject );
 
-		pJoltWheelObject->SetGameFlags( m_pCarBodyObject->GetGameFlags() );
-		pJoltWheelObject->SetCallbackFlags( CALLBACK_IS_VEHICLE_WHEEL );
-		// Josh: The wheel is a fake object, so disable collisions on it.
-		pJoltWheelObject->EnableCollisions( false );
+		// The wheel is a proxy with no body of its own, the vehicle constraint simulates it.
+		JoltPhysicsVehicleWheel *pWheelObject = new JoltPhysicsVehicleWheel( this, int( m_Wheels.size() ), wheelRadius, axle.wheels.materialIndex, wheelParams );
+		pWheelObject->SetGameFlags( m_pCarBodyObject->GetGameFlags() );
 
-		m_Wheels.push_back( JoltPhysicsWheel{ .pObject = pJoltWheelObject } );
+		m_Wheels.push_back( JoltPhysicsWheel{ .pObject = pWheelObject } );
 	}
 
 	const float steeringAngle = DEG2RAD( Max( m_VehicleParams.steering.degreesSlow, m_VehicleParams.steering.degreesFast ) );
@@ -539,7 +644,7 @@ void JoltPhysicsVehicleController::DetachObject()
 		// Remove the listeners and constraint now, we can never
 		// attach to another body.
 		m_pPhysicsSystem->RemoveConstraint( m_VehicleConstraint );
-		m_pPhysicsSystem->RemoveStepListener( m_VehicleConstraint );
+		m_pPhysicsSystem->RemoveStepListener( &m_StepListener );
 
 		m_pCarBodyObject = nullptr;
 	}
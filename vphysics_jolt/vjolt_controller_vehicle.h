@@ -4,9 +4,11 @@
 #include "vjolt_object.h" // IJoltObjectDestroyedListener
 #include "vjolt_environment.h" // IJoltPhysicsController
 
+class JoltPhysicsVehicleWheel;
+
 struct JoltPhysicsWheel
 {
-	JoltPhysicsObject* pObject = nullptr;
+	JoltPhysicsVehicleWheel* pObject = nullptr;
 	bool InWater = false;
 	float Depth = 0.0f;
 };
@@ -19,6 +21,24 @@ struct JoltPhysicsInternalVehicleState
 	float LargestWheelRadius = 0.0f;
 };
 
+class JoltPhysicsVehicleController;
+
+// Steps the vehicle constraint on behalf of the controller,
+// so it can skip or thin out steps for vehicles nobody is using.
+class JoltVehicleStepListener final : public JPH::PhysicsStepListener
+{
+public:
+	JoltVehicleStepListener( JoltPhysicsVehicleController *pController )
+		: m_pController( pController )
+	{
+	}
+
+	void OnStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem ) override;
+
+private:
+	JoltPhysicsVehicleController *m_pController;
+};
+
 class JoltPhysicsVehicleController final : public IPhysicsVehicleController, public IJoltObjectDestroyedListener, public IJoltPhysicsController
 {
 public:
@@ -53,12 +73,31 @@ public:
 
 	float GetSpeed();
 
+	JoltPhysicsObject *GetCarBodyObject() const { return m_pCarBodyObject; }
+
+	// Returns false if the vehicle has lost its body, and transform is left alone.
+	bool GetWheelWorldTransform( int nWheel, JPH::Mat44 &transform ) const;
+	float GetWheelAngularVelocity( int nWheel ) const;
+
+	// Appends our wheels to the list if the car is awake, or always if bIncludeAsleep.
+	void GetActiveWheels( std::vector< IPhysicsObject * > &wheels, bool bIncludeAsleep ) const;
+
 	// IJoltPhysicsController
 	void OnPreSimulate( float flDeltaTime ) override;
 	void OnPostSimulate( float flDeltaTime ) override;
 
+	void OnVehicleStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem );
+
 private:
 
+	bool HasDriverInput() const;
+	void UpdateLOD();
+
+	// Whether the wheel contacts from the last step can be used again instead of casting the wheels,
+	// the car has to be sitting still with only static things under its wheels.
+	bool HasValidWheelContacts() const;
+	static constexpr float kLODRestingSpeedSq = 1.0e-4f;
+
 	void HandleBoostKey();
 	void HandleBoostDecay();
 
@@ -89,5 +128,12 @@ private:
 	JPH::Ref< JPH::VehicleConstraint >		m_VehicleConstraint;
 	JPH::Ref< JPH::VehicleCollisionTester >	m_Tester;
 
+	// Vehicle LOD, unoccupied vehicles away from any player only get
+	// their wheels and controller updated every m_nLODInterval steps.
+	JoltVehicleStepListener					m_StepListener{ this };
+	bool									m_bOccupied = false;
+	int										m_nLODInterval = 1;
+	int										m_nLODSkippedSteps = 0;
+	float									m_flLODSkippedTime = 0.0f;
 
 };
@@ -26,6 +26,7 @@
 #include "vjolt_layers.h"
 #include "vjolt_object.h"
 #include "vjolt_state_recorder_file.h"
+#include "vjolt_surfaceprops.h"
 
 #include "vjolt_environment.h"
 
@@ -54,6 +55,14 @@ static ConVar vjolt_initial_simulation( "vjolt_initial_simulation", "0", FCVAR_N
 
 static ConVar vjolt_substeps_collision( "vjolt_substeps_collision", "1", FCVAR_NONE, "Number of collision steps to perform.", true, 0.0f, true, 4.0f );
 
+static ConVar vjolt_debugcheckcontacts_interval( "vjolt_debugcheckcontacts_interval", "0", FCVAR_NONE, "How often in seconds to run DebugCheckContacts automatically, 0 to only run it when the game asks." );
+static ConVar vjolt_debugcheckcontacts_depth( "vjolt_debugcheckcontacts_depth", "2", FCVAR_NONE, "How deep in inches a body has to be inside of something for DebugCheckContacts to report it." );
+static ConVar vjolt_debugcheckcontacts_report( "vjolt_debugcheckcontacts_report", "8", FCVAR_NONE, "The most bodies DebugCheckContacts will report at once, deepest first." );
+static ConVar vjolt_debugcheckcontacts_depenetrate( "vjolt_debugcheckcontacts_depenetrate", "0", FCVAR_NONE, "Whether DebugCheckContacts pushes the bodies it reports back out of what they are stuck in." );
+
+static ConVar vjolt_precision_velocity_steps( "vjolt_precision_velocity_steps", "15", FCVAR_NONE, "Velocity steps for islands with vehicles, ragdolls or large constraint groups in them, 0 to use the global setting.", true, 0.0f, true, 255.0f );
+static ConVar vjolt_precision_position_steps( "vjolt_precision_position_steps", "4", FCVAR_NONE, "Position steps for islands with vehicles, ragdolls or large constraint groups in them, 0 to use the global setting.", true, 0.0f, true, 255.0f );
+
 static ConVar vjolt_baumgarte_factor( "vjolt_baumgarte_factor", "0.2", FCVAR_NONE, "Baumgarte stabilization factor (how much of the position error to 'fix' in 1 update). Changing this may help with constraint stability. Requires a map restart to change.", true, 0.0f, true, 1.0f );
 
 //-------------------------------------------------------------------------------------------------
@@ -197,8 +206,37 @@ JoltBroadPhaseLayerInterface JoltPhysicsEnvironment::s_BroadPhaseLayerInterface;
 JoltObjectVsBroadPhaseLayerFilter JoltPhysicsEnvironment::s_BroadPhaseFilter;
 JoltObjectLayerPairFilter JoltPhysicsEnvironment::s_LayerPairFilter;
 
+// Only static world geometry has materials per triangle (see vjolt_collide.cpp),
+// everything else just uses the friction and restitution on the body.
+static int GetContactSurfaceIndex( const JPH::Body &body, const JPH::SubShapeID &subShapeID )
+{
+	if ( !body.IsStatic() )
+		return -1;
+
+	return JoltPhysicsSurfaceProps::GetInstance().GetMaterialSurfaceIndex( body.GetShape()->GetMaterial( subShapeID ) );
+}
+
+static float GetContactFriction( const JPH::Body &body, const JPH::SubShapeID &subShapeID )
+{
+	const int nSurfaceIndex = GetContactSurfaceIndex( body, subShapeID );
+	if ( nSurfaceIndex < 0 )
+		return body.GetFriction();
+
+	return JoltPhysicsSurfaceProps::GetInstance().GetPhysicsParams( nSurfaceIndex ).friction;
+}
+
+static float GetContactRestitution( const JPH::Body &body, const JPH::SubShapeID &subShapeID )
+{
+	const int nSurfaceIndex = GetContactSurfaceIndex( body, subShapeID );
+	if ( nSurfaceIndex < 0 )
+		return body.GetRestitution();
+
+	return JoltPhysicsSurfaceProps::GetInstance().GetPhysicsParams( nSurfaceIndex ).elasticity;
+}
+
 JoltPhysicsEnvironment::JoltPhysicsEnvironment()
 	: m_ContactListener( m_PhysicsSystem )
+	, m_ActivationListener( m_PhysicsSystem )
 {
 	m_PerformanceParams.Defaults();
 
@@ -215,24 +253,26 @@ JoltPhysicsEnvironment::JoltPhysicsEnvironment()
 	// A body activation listener gets notified when bodies activate and go to sleep
 	// Note that this is called from a job so whatever you do here needs to be thread safe.
 	// Registering one is entirely optional.
-	//m_PhysicsSystem.SetBodyActivationListener( &vars.bodyActivationListener );
+	m_PhysicsSystem.SetBodyActivationListener( &m_ActivationListener );
 
 	// A contact listener gets notified when bodies (are about to) collide, and when they separate again.
 	// Note that this is called from a job so whatever you do here needs to be thread safe.
 	// Registering one is entirely optional.
 	m_PhysicsSystem.SetContactListener( &m_ContactListener );
 
+	m_PhysicsSystem.AddStepListener( &m_AlternateGravityListener );
+
 	// Source clamps friction from 0 -> 1, so lets do that.
 	m_PhysicsSystem.SetCombineFriction( []( const JPH::Body &inBody1, const JPH::SubShapeID &inSubShapeID1, const JPH::Body &inBody2, const JPH::SubShapeID &inSubShapeID2 ) -> float
 	{
-		return Clamp( inBody1.GetFriction() * inBody2.GetFriction(), 0.0f, 1.0f );
+		return Clamp( GetContactFriction( inBody1, inSubShapeID1 ) * GetContactFriction( inBody2, inSubShapeID2 ), 0.0f, 1.0f );
 	} );
 
 	// Jolt normally does max( x, y ) for resitution, but
 	// Source's values expect them to be multiplied and clamped.
 	m_PhysicsSystem.SetCombineRestitution( []( const JPH::Body &inBody1, const JPH::SubShapeID& inSubShapeID1, const JPH::Body &inBody2, const JPH::SubShapeID& inSubShapeID2 ) -> float
 	{
-		return Clamp( inBody1.GetRestitution() * inBody2.GetRestitution(), 0.0f, 1.0f );
+		return Clamp( GetContactRestitution( inBody1, inSubShapeID1 ) * GetContactRestitution( inBody2, inSubShapeID2 ), 0.0f, 1.0f );
 	} );
 
 	// Set our linear cast member
@@ -241,6 +281,8 @@ JoltPhysicsEnvironment::JoltPhysicsEnvironment()
 
 JoltPhysicsEnvironment::~JoltPhysicsEnvironment()
 {
+	m_PhysicsSystem.RemoveStepListener( &m_AlternateGravityListener );
+
 	// Clear any pending dead bodies.
 	DeleteDeadObjects();
 
@@ -283,6 +325,8 @@ void JoltPhysicsEnvironment::SetGravity( const Vector &gravityVector )
 {
 	JPH::Vec3 gravity = SourceToJolt::Distance( gravityVector );
 	m_PhysicsSystem.SetGravity( gravity );
+
+	UpdateAlternateGravity();
 }
 
 void JoltPhysicsEnvironment::GetGravity( Vector *pGravityVector ) const
@@ -317,18 +361,26 @@ static objectparams_t NormalizeObjectParams( objectparams_t* pParams )
 	return params;
 }
 
+// Wraps the shape so its center of mass is where the game asked for, either explicitly
+// or earlier on the collide with CollideSetMassCenter.
+static const JPH::Shape *ApplyMassCenterOverride( const JPH::Shape *pShape, const Vector *pMassCenterOverride )
+{
+	JPH::Vec3 massCenterOverride;
+	if ( pMassCenterOverride )
+		return CreateCOMOverrideShape( pShape, SourceToJolt::Distance( *pMassCenterOverride ) );
+	else if ( GetCollideMassCenterOverride( pShape, massCenterOverride ) )
+		return CreateCOMOverrideShape( pShape, massCenterOverride );
+
+	return pShape;
+}
+
 //-------------------------------------------------------------------------------------------------
 
 IPhysicsObject *JoltPhysicsEnvironment::CreatePolyObject( const CPhysCollide *pCollisionModel, int materialIndex, const Vector &position, const QAngle &angles, objectparams_t *pParams )
 {
 	objectparams_t params = NormalizeObjectParams( pParams );
 
-	const JPH::Shape* pShape = pCollisionModel->ToShape();
-	if ( params.massCenterOverride )
-	{
-		JPH::Vec3 massCenterOverride = SourceToJolt::Distance( *params.massCenterOverride );
-		pShape = CreateCOMOverrideShape( pShape, massCenterOverride );
-	}
+	const JPH::Shape *pShape = ApplyMassCenterOverride( pCollisionModel->ToShape(), params.massCenterOverride );
 
 	JPH::BodyCreationSettings settings( pShape, SourceToJolt::Distance( position ), SourceToJolt::Angle( angles ), JPH::EMotionType::Dynamic, Layers::MOVING );
 	settings.mMassPropertiesOverride.mMass = params.mass;
@@ -393,11 +445,11 @@ IPhysicsObject *JoltPhysicsEnvironment::CreateSphereObject( float radius, int ma
 
 void JoltPhysicsEnvironment::DestroyObject( IPhysicsObject *pObject )
 {
-	if ( !pObject )
+	// Wheels are owned by their vehicle controller.
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
 		return;
 
-	JoltPhysicsObject *pJoltObject = static_cast<JoltPhysicsObject *>( pObject );
-
 	if ( pJoltObject->GetCallbackFlags() & CALLBACK_MARKED_FOR_DELETE )
 	{
 		// Object deleted twice.
@@ -419,7 +471,13 @@ void JoltPhysicsEnvironment::DestroyObject( IPhysicsObject *pObject )
 
 IPhysicsFluidController *JoltPhysicsEnvironment::CreateFluidController( IPhysicsObject *pFluidObject, fluidparams_t *pParams )
 {
-	JoltPhysicsObject *pJoltObject = static_cast< JoltPhysicsObject * >( pFluidObject );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pFluidObject );
+	if ( !pJoltObject )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a fluid controller without a physics object.\n" );
+		return nullptr;
+	}
+
 	JoltPhysicsFluidController *pFluidController = new JoltPhysicsFluidController( &m_PhysicsSystem, pJoltObject, pParams );
 	m_pPhysicsControllers.push_back( pFluidController );
 	return pFluidController;
@@ -570,8 +628,13 @@ void JoltPhysicsSpring::OnJoltPhysicsObjectDestroyed( JoltPhysicsObject *pObject
 
 IPhysicsSpring *JoltPhysicsEnvironment::CreateSpring( IPhysicsObject *pObjectStart, IPhysicsObject *pObjectEnd, springparams_t *pParams )
 {
-	JoltPhysicsObject *pJoltObjectStart = static_cast< JoltPhysicsObject *>( pObjectStart );
-	JoltPhysicsObject *pJoltObjectEnd = static_cast< JoltPhysicsObject *>( pObjectEnd );
+	JoltPhysicsObject *pJoltObjectStart = ToJoltPhysicsObject( pObjectStart );
+	JoltPhysicsObject *pJoltObjectEnd = ToJoltPhysicsObject( pObjectEnd );
+	if ( !pJoltObjectStart || !pJoltObjectEnd )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a spring without two physics objects.\n" );
+		return nullptr;
+	}
 
 	return new JoltPhysicsSpring( &m_PhysicsSystem, pJoltObjectStart, pJoltObjectEnd, pParams );
 }
@@ -584,8 +647,22 @@ void JoltPhysicsEnvironment::DestroySpring( IPhysicsSpring *pSpring )
 
 //-------------------------------------------------------------------------------------------------
 
+static bool CanConstrainObjects( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject )
+{
+	if ( !ToJoltPhysicsObject( pReferenceObject ) || !ToJoltPhysicsObject( pAttachedObject ) )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a constraint without two physics objects.\n" );
+		return false;
+	}
+
+	return true;
+}
+
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateRagdollConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_ragdollparams_t &ragdoll )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseRagdoll( pGroup, ragdoll );
 	return pConstraint;
@@ -593,6 +670,9 @@ IPhysicsConstraint *JoltPhysicsEnvironment::CreateRagdollConstraint( IPhysicsObj
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateHingeConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_hingeparams_t &hinge )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseHinge( pGroup, hinge );
 	return pConstraint;
@@ -600,6 +680,9 @@ IPhysicsConstraint *JoltPhysicsEnvironment::CreateHingeConstraint( IPhysicsObjec
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateFixedConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_fixedparams_t &fixed )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseFixed( pGroup, fixed );
 	return pConstraint;
@@ -607,6 +690,9 @@ IPhysicsConstraint *JoltPhysicsEnvironment::CreateFixedConstraint( IPhysicsObjec
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateSlidingConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_slidingparams_t &sliding )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseSliding( pGroup, sliding );
 	return pConstraint;
@@ -614,6 +700,9 @@ IPhysicsConstraint *JoltPhysicsEnvironment::CreateSlidingConstraint( IPhysicsObj
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateBallsocketConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_ballsocketparams_t &ballsocket )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseBallsocket( pGroup, ballsocket );
 	return pConstraint;
@@ -621,12 +710,19 @@ IPhysicsConstraint *JoltPhysicsEnvironment::CreateBallsocketConstraint( IPhysics
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreatePulleyConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_pulleyparams_t &pulley )
 {
-	Log_Stub( LOG_VJolt );
-	return nullptr;
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
+	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
+	pConstraint->InitialisePulley( pGroup, pulley );
+	return pConstraint;
 }
 
 IPhysicsConstraint *JoltPhysicsEnvironment::CreateLengthConstraint( IPhysicsObject *pReferenceObject, IPhysicsObject *pAttachedObject, IPhysicsConstraintGroup *pGroup, const constraint_lengthparams_t &length )
 {
+	if ( !CanConstrainObjects( pReferenceObject, pAttachedObject ) )
+		return nullptr;
+
 	JoltPhysicsConstraint *pConstraint = new JoltPhysicsConstraint( this, pReferenceObject, pAttachedObject );
 	pConstraint->InitialiseLength( pGroup, length );
 	return pConstraint;
@@ -667,19 +763,30 @@ void JoltPhysicsEnvironment::DestroyConstraint( IPhysicsConstraint *pConstraint
 
 IPhysicsConstraintGroup *JoltPhysicsEnvironment::CreateConstraintGroup( const constraint_groupparams_t &groupParams )
 {
-	return new JoltPhysicsConstraintGroup;
+	JoltPhysicsConstraintGroup *pGroup = new JoltPhysicsConstraintGroup( this, groupParams );
+	m_pPhysicsControllers.push_back( pGroup );
+	return pGroup;
 }
 
 void JoltPhysicsEnvironment::DestroyConstraintGroup( IPhysicsConstraintGroup *pGroup )
 {
-	delete static_cast<JoltPhysicsConstraintGroup *>( pGroup );
+	JoltPhysicsConstraintGroup *pJoltGroup = static_cast<JoltPhysicsConstraintGroup *>( pGroup );
+	Erase( m_pPhysicsControllers, pJoltGroup );
+	delete pJoltGroup;
 }
 
 //-------------------------------------------------------------------------------------------------
 
 IPhysicsShadowController *JoltPhysicsEnvironment::CreateShadowController( IPhysicsObject *pObject, bool allowTranslation, bool allowRotation )
 {
-	JoltPhysicsShadowController *pController = new JoltPhysicsShadowController( static_cast<JoltPhysicsObject *>( pObject ), allowTranslation, allowRotation );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a shadow controller without a physics object.\n" );
+		return nullptr;
+	}
+
+	JoltPhysicsShadowController *pController = new JoltPhysicsShadowController( pJoltObject, allowTranslation, allowRotation );
 	m_pPhysicsControllers.push_back( pController );
 	return pController;
 }
@@ -695,8 +802,16 @@ void JoltPhysicsEnvironment::DestroyShadowController( IPhysicsShadowController *
 
 IPhysicsPlayerController *JoltPhysicsEnvironment::CreatePlayerController( IPhysicsObject *pObject )
 {
-	JoltPhysicsPlayerController *pController = new JoltPhysicsPlayerController( static_cast<JoltPhysicsObject *>( pObject ) );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a player controller without a physics object.\n" );
+		return nullptr;
+	}
+
+	JoltPhysicsPlayerController *pController = new JoltPhysicsPlayerController( pJoltObject );
 	m_pPhysicsControllers.push_back( pController );
+	m_pPlayerControllers.push_back( pController );
 	return pController;
 }
 
@@ -704,6 +819,7 @@ void JoltPhysicsEnvironment::DestroyPlayerController( IPhysicsPlayerController *
 {
 	JoltPhysicsPlayerController *pController = static_cast< JoltPhysicsPlayerController * >( pPlayerController );
 	Erase( m_pPhysicsControllers, pController );
+	Erase( m_pPlayerControllers, pController );
 	delete pController;
 }
 
@@ -727,10 +843,16 @@ void JoltPhysicsEnvironment::DestroyMotionController( IPhysicsMotionController *
 
 IPhysicsVehicleController *JoltPhysicsEnvironment::CreateVehicleController( IPhysicsObject *pVehicleBodyObject, const vehicleparams_t &params, unsigned int nVehicleType, IPhysicsGameTrace *pGameTrace )
 {
-	JoltPhysicsObject *pJoltCarBodyObject = static_cast< JoltPhysicsObject * >( pVehicleBodyObject );
+	JoltPhysicsObject *pJoltCarBodyObject = ToJoltPhysicsObject( pVehicleBodyObject );
+	if ( !pJoltCarBodyObject )
+	{
+		Log_Warning( LOG_VJolt, "Tried to create a vehicle controller without a physics object.\n" );
+		return nullptr;
+	}
 
 	JoltPhysicsVehicleController *pController = new JoltPhysicsVehicleController( this, &m_PhysicsSystem, pJoltCarBodyObject, params, nVehicleType, pGameTrace );
 	m_pPhysicsControllers.push_back( pController );
+	m_pVehicleControllers.push_back( pController );
 	return pController;
 }
 
@@ -738,6 +860,7 @@ void JoltPhysicsEnvironment::DestroyVehicleController( IPhysicsVehicleController
 {
 	JoltPhysicsVehicleController *pJoltController = static_cast<JoltPhysicsVehicleController *>( pVehicleController );
 	Erase( m_pPhysicsControllers, pJoltController );
+	Erase( m_pVehicleControllers, pJoltController );
 	delete pJoltController;
 }
 
@@ -809,6 +932,7 @@ void JoltPhysicsEnvironment::Simulate( float deltaTime )
 		m_PhysicsSystem.Update( deltaTime, nCollisionSubSteps, tempAllocator, jobSystem );
 	}
 	m_ContactListener.FlushCallbacks();
+	m_ActivationListener.FlushCallbacks();
 
 	// Run post-simulation controllers
 	for ( IJoltPhysicsController *pController : m_pPhysicsControllers )
@@ -816,6 +940,17 @@ void JoltPhysicsEnvironment::Simulate( float deltaTime )
 
 	m_bSimulating = false;
 
+	const float flDebugCheckContactsInterval = vjolt_debugcheckcontacts_interval.GetFloat();
+	if ( flDebugCheckContactsInterval > 0.0f )
+	{
+		m_flDebugCheckContactsTime += deltaTime;
+		if ( m_flDebugCheckContactsTime >= flDebugCheckContactsInterval )
+		{
+			m_flDebugCheckContactsTime = 0.0f;
+			DebugCheckContacts();
+		}
+	}
+
 	// If the delete queue is disabled, we only added to it during the simulation
 	// ie. callbacks etc. So flush that now.
 	if ( !m_bEnableDeleteQueue )
@@ -871,7 +1006,7 @@ void JoltPhysicsEnvironment::SetCollisionEventHandler( IPhysicsCollisionEvent *p
 
 void JoltPhysicsEnvironment::SetObjectEventHandler( IPhysicsObjectEvent *pObjectEvents )
 {
-	Log_Stub( LOG_VJolt );
+	m_ActivationListener.SetGameListener( pObjectEvents );
 }
 
 void JoltPhysicsEnvironment::SetConstraintEventHandler( IPhysicsConstraintEvent *pConstraintEvents )
@@ -911,12 +1046,16 @@ int JoltPhysicsEnvironment::GetActiveObjectCount() const
 		// If this is the first call, then some objects may have become
 		// asleep from the initial simulation have their visuals not match where they are.
 		m_PhysicsSystem.GetBodies( m_CachedActiveBodies );
-		m_bActiveObjectCountFirst = false;
 	}
 
+	m_CachedActiveWheels.clear();
+	for ( JoltPhysicsVehicleController *pController : m_pVehicleControllers )
+		pController->GetActiveWheels( m_CachedActiveWheels, m_bActiveObjectCountFirst );
+
+	m_bActiveObjectCountFirst = false;
 	m_DirtyStaticBodies.clear();
 
-	return int( m_CachedActiveBodies.size() );
+	return int( m_CachedActiveBodies.size() + m_CachedActiveWheels.size() );
 }
 
 void JoltPhysicsEnvironment::GetActiveObjects( IPhysicsObject **pOutputObjectList ) const
@@ -927,6 +1066,10 @@ void JoltPhysicsEnvironment::GetActiveObjects( IPhysicsObject **pOutputObjectLis
 		JPH::Body *pBody = m_PhysicsSystem.GetBodyLockInterfaceNoLock().TryGetBody( m_CachedActiveBodies[ i ] );
 		pOutputObjectList[ i ] = reinterpret_cast<IPhysicsObject *>( pBody->GetUserData() );
 	}
+
+	const int nWheelCount = int( m_CachedActiveWheels.size() );
+	for ( int i = 0; i < nWheelCount; i++ )
+		pOutputObjectList[ nCount + i ] = m_CachedActiveWheels[ i ];
 }
 
 const IPhysicsObject **JoltPhysicsEnvironment::GetObjectList( int *pOutputObjectCount ) const
@@ -950,7 +1093,10 @@ const IPhysicsObject **JoltPhysicsEnvironment::GetObjectList( int *pOutputObject
 
 bool JoltPhysicsEnvironment::TransferObject( IPhysicsObject *pObject, IPhysicsEnvironment *pDestinationEnvironment )
 {
-	JoltPhysicsObject *pJoltObject = static_cast< JoltPhysicsObject * >( pObject );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
+		return false;
+
 	JoltPhysicsEnvironment *pJoltEnv = static_cast< JoltPhysicsEnvironment * >( pDestinationEnvironment );
 
 	JPH::BodyInterface &bodyInterface = m_PhysicsSystem.GetBodyInterfaceNoLock();
@@ -1022,7 +1168,13 @@ bool JoltPhysicsEnvironment::Save( const physsaveparams_t &params )
 			return false;
 		case PIID_IPHYSICSOBJECT:
 		{
-			JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( params.pObject );
+			JoltPhysicsObject *pObject = ToJoltPhysicsObject( static_cast< IPhysicsObject * >( params.pObject ) );
+			if ( !pObject )
+			{
+				Log_Warning( LOG_VJolt, "Saving vehicle wheels is unsupported right now.\n" );
+				return false;
+			}
+
 			JPH::BodyCreationSettings bodyCreationSettings = pObject->GetBody()->GetBodyCreationSettings();
 
 			recorder.Write( reinterpret_cast<uintptr_t>( pObject ) );
@@ -1092,7 +1244,9 @@ bool JoltPhysicsEnvironment::Restore( const physrestoreparams_t &params )
 			return false;
 		case PIID_IPHYSICSOBJECT:
 		{
-			const JPH::Shape* pShape = params.pCollisionModel->ToShape();
+			// Only the collide's own mass center survives a save, the one from objectparams_t
+			// isn't in physrestoreparams_t.
+			const JPH::Shape *pShape = ApplyMassCenterOverride( params.pCollisionModel->ToShape(), nullptr );
 			JPH::BodyCreationSettings bodyCreationSettings;
 			uintp originalPtr;
 
@@ -1250,7 +1404,10 @@ public:
 
 unsigned int JoltPhysicsEnvironment::GetObjectSerializeSize( IPhysicsObject *pObject ) const
 {
-	JoltPhysicsObject *pJoltObject = static_cast<JoltPhysicsObject *>( pObject );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
+		return 0;
+
 	const JPH::Body *pBody = pJoltObject->GetBody();
 
 	VJoltStateSizeRecorder recorder;
@@ -1265,7 +1422,10 @@ unsigned int JoltPhysicsEnvironment::GetObjectSerializeSize( IPhysicsObject *pOb
 
 void JoltPhysicsEnvironment::SerializeObjectToBuffer( IPhysicsObject *pObject, unsigned char *pBuffer, unsigned int bufferSize )
 {
-	JoltPhysicsObject *pJoltObject = static_cast<JoltPhysicsObject *>( pObject );
+	JoltPhysicsObject *pJoltObject = ToJoltPhysicsObject( pObject );
+	if ( !pJoltObject )
+		return;
+
 	const JPH::Body *pBody = pJoltObject->GetBody();
 
 	VJoltStateRecorder recorder( pBuffer, bufferSize );
@@ -1310,21 +1470,181 @@ void JoltPhysicsEnvironment::EnableConstraintNotify( bool bEnable )
 	m_EnableConstraintNotify = bEnable;
 }
 
+namespace
+{
+	struct DebugContact_t
+	{
+		JPH::BodyID	bodyID;
+		JPH::BodyID	otherBodyID;
+		JPH::Vec3	penetrationAxis;
+		float		flDepth;
+	};
+
+	class DebugContactBodyFilter : public JPH::BodyFilter
+	{
+	public:
+		DebugContactBodyFilter( JoltPhysicsContactListener *pContactListener, JoltPhysicsObject *pSelfObject )
+			: m_pContactListener( pContactListener )
+			, m_pSelfObject( pSelfObject )
+		{
+		}
+
+		bool ShouldCollideLocked( const JPH::Body &inBody ) const override
+		{
+			JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( inBody.GetUserData() );
+			if ( pObject == m_pSelfObject || inBody.IsSensor() )
+				return false;
+
+			// Don't count things that are meant to be inside each other, ie. bones of the same ragdoll.
+			return m_pContactListener->ShouldCollide( m_pSelfObject, pObject );
+		}
+
+	private:
+		JoltPhysicsContactListener	*m_pContactListener;
+		JoltPhysicsObject			*m_pSelfObject;
+	};
+}
+
 void JoltPhysicsEnvironment::DebugCheckContacts()
 {
-	Log_Stub( LOG_VJolt );
+	// Jolt keeps its contact constraints to itself, so find every active body's
+	// deepest contact with the narrow phase instead, spread out over the job system.
+	JPH::BodyIDVector bodyIDs;
+	m_PhysicsSystem.GetActiveBodies( bodyIDs );
+	if ( bodyIDs.empty() )
+		return;
+
+	const int nBodyCount = int( bodyIDs.size() );
+	std::vector< DebugContact_t > contacts( nBodyCount );
+
+	auto FindDeepestContact = [ this, &bodyIDs, &contacts ]( int nIndex )
+	{
+		DebugContact_t &contact = contacts[ nIndex ];
+		contact.bodyID = bodyIDs[ nIndex ];
+		contact.flDepth = 0.0f;
+
+		const JPH::Body *pBody = m_PhysicsSystem.GetBodyLockInterfaceNoLock().TryGetBody( contact.bodyID );
+		if ( !pBody || pBody->IsSensor() )
+			return;
+
+		JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( pBody->GetUserData() );
+		if ( !pObject->IsCollisionEnabled() )
+			return;
+
+		JPH::CollideShapeSettings settings;
+		settings.mActiveEdgeMode = JPH::EActiveEdgeMode::CollideOnlyWithActive;
+		settings.mBackFaceMode = JPH::EBackFaceMode::IgnoreBackFaces;
+
+		// ClosestHitCollisionCollector orders by negative penetration depth, so this gives us the deepest hit.
+		JPH::ClosestHitCollisionCollector< JPH::CollideShapeCollector > collector;
+		DebugContactBodyFilter bodyFilter( &m_ContactListener, pObject );
+
+		const JPH::ObjectLayer layer = pBody->GetObjectLayer();
+		m_PhysicsSystem.GetNarrowPhaseQueryNoLock().CollideShape(
+			pBody->GetShape(), JPH::Vec3::sReplicate( 1.0f ), pBody->GetCenterOfMassTransform(), settings, JPH::Vec3::sZero(), collector,
+			m_PhysicsSystem.GetDefaultBroadPhaseLayerFilter( layer ), m_PhysicsSystem.GetDefaultLayerFilter( layer ), bodyFilter );
+
+		if ( !collector.HadHit() )
+			return;
+
+		contact.otherBodyID = collector.mHit.mBodyID2;
+		contact.penetrationAxis = collector.mHit.mPenetrationAxis;
+		contact.flDepth = collector.mHit.mPenetrationDepth;
+	};
+
+	static constexpr int kBodiesPerJob = 64;
+
+	JPH::JobSystem *pJobSystem = JoltPhysicsInterface::GetInstance().GetJobSystem();
+	JPH::JobSystem::Barrier *pBarrier = pJobSystem->CreateBarrier();
+	for ( int nStart = 0; nStart < nBodyCount; nStart += kBodiesPerJob )
+	{
+		const int nEnd = Min( nStart + kBodiesPerJob, nBodyCount );
+		JPH::JobHandle job = pJobSystem->CreateJob( "DebugCheckContacts", JPH::Color::sGrey, [ &FindDeepestContact, nStart, nEnd ]()
+		{
+			for ( int i = nStart; i < nEnd; i++ )
+				FindDeepestContact( i );
+		});
+		pBarrier->AddJob( job );
+	}
+	pJobSystem->WaitForJobs( pBarrier );
+	pJobSystem->DestroyBarrier( pBarrier );
+
+	// Only keep the ones that are worth shouting about, deepest first.
+	const float flMinDepth = SourceToJolt::Distance( vjolt_debugcheckcontacts_depth.GetFloat() );
+	EraseIf( contacts, [ flMinDepth ]( const DebugContact_t &contact ) { return contact.flDepth <= flMinDepth; } );
+	if ( contacts.empty() )
+		return;
+
+	std::sort( contacts.begin(), contacts.end(),
+		[]( const DebugContact_t &a, const DebugContact_t &b ) { return a.flDepth > b.flDepth; } );
+
+	// When both bodies of a pair are active they each find the other, only keep
+	// the deeper of the two so the pair isn't reported or pushed apart twice.
+	std::unordered_set< uint64 > seenPairs;
+	EraseIf( contacts, [ &seenPairs ]( const DebugContact_t &contact )
+	{
+		const uint64 uID = contact.bodyID.GetIndexAndSequenceNumber();
+		const uint64 uOtherID = contact.otherBodyID.GetIndexAndSequenceNumber();
+		const uint64 uPairKey = uID < uOtherID ? ( uID << 32 ) | uOtherID : ( uOtherID << 32 ) | uID;
+		return !seenPairs.insert( uPairKey ).second;
+	} );
+
+	const int nReportCount = Min( int( contacts.size() ), Max( vjolt_debugcheckcontacts_report.GetInt(), 0 ) );
+
+	Log_Warning( LOG_VJolt, "DebugCheckContacts: %d pairs of bodies out of %d active bodies are more than %.2f inches inside of each other.\n",
+		int( contacts.size() ), nBodyCount, vjolt_debugcheckcontacts_depth.GetFloat() );
+
+	const bool bDepenetrate = vjolt_debugcheckcontacts_depenetrate.GetBool();
+	JPH::BodyInterface &bodyInterface = m_PhysicsSystem.GetBodyInterfaceNoLock();
+	const JPH::BodyLockInterfaceNoLock &bodyLockInterface = m_PhysicsSystem.GetBodyLockInterfaceNoLock();
+	for ( int i = 0; i < nReportCount; i++ )
+	{
+		const DebugContact_t &contact = contacts[ i ];
+
+		const JPH::Body *pBody = bodyLockInterface.TryGetBody( contact.bodyID );
+		const JPH::Body *pOtherBody = bodyLockInterface.TryGetBody( contact.otherBodyID );
+		if ( !pBody || !pOtherBody )
+			continue;
+
+		JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( pBody->GetUserData() );
+		JoltPhysicsObject *pOtherObject = reinterpret_cast< JoltPhysicsObject * >( pOtherBody->GetUserData() );
+
+		const Vector vecPosition = JoltToSource::Distance( pBody->GetPosition() );
+		Log_Warning( LOG_VJolt, "  %s (game data %p) at (%.1f %.1f %.1f) is %.2f inches inside of %s (game data %p)\n",
+			pObject->GetName(), pObject->GetGameData(), vecPosition.x, vecPosition.y, vecPosition.z,
+			JoltToSource::Distance( contact.flDepth ), pOtherObject->GetName(), pOtherObject->GetGameData() );
+
+		if ( !bDepenetrate || contact.penetrationAxis.IsNearZero() )
+			continue;
+
+		// The penetration axis points in the direction that moves the other body out of ours,
+		// split the correction by inverse mass so pinned or static objects stay put.
+		const float flInvMass = pObject->IsMoveable() ? pObject->GetInvMass() : 0.0f;
+		const float flOtherInvMass = pOtherObject->IsMoveable() ? pOtherObject->GetInvMass() : 0.0f;
+		const float flTotalInvMass = flInvMass + flOtherInvMass;
+		if ( flTotalInvMass <= 0.0f )
+			continue;
+
+		const JPH::Vec3 separation = contact.penetrationAxis.Normalized() * contact.flDepth;
+		if ( flInvMass > 0.0f )
+			bodyInterface.SetPosition( contact.bodyID, pBody->GetPosition() - separation * ( flInvMass / flTotalInvMass ), JPH::EActivation::Activate );
+		if ( flOtherInvMass > 0.0f )
+			bodyInterface.SetPosition( contact.otherBodyID, pOtherBody->GetPosition() + separation * ( flOtherInvMass / flTotalInvMass ), JPH::EActivation::Activate );
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
 
 void JoltPhysicsEnvironment::SetAlternateGravity( const Vector &gravityVector )
 {
-	Log_Stub( LOG_VJolt );
+	m_AlternateGravity = SourceToJolt::Distance( gravityVector );
+	UpdateAlternateGravity();
 }
 
 void JoltPhysicsEnvironment::GetAlternateGravity( Vector *pGravityVector ) const
 {
-	Log_Stub( LOG_VJolt );
+	VJoltAssert( pGravityVector );
+	*pGravityVector = JoltToSource::Distance( m_AlternateGravity );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1411,6 +1731,115 @@ void JoltPhysicsEnvironment::NotifyConstraintDisabled( JoltPhysicsConstraint* pC
 
 //-------------------------------------------------------------------------------------------------
 
+void JoltPhysicsEnvironment::ApplyPrecisionStepsOverride( JPH::Constraint *pConstraint )
+{
+	if ( !pConstraint )
+		return;
+
+	// Jolt solves each island with the most steps anything in it asks for,
+	// so this only costs us on the islands these constraints end up in
+	// rather than bumping the steps for the whole world.
+	pConstraint->SetNumVelocityStepsOverride( vjolt_precision_velocity_steps.GetInt() );
+	pConstraint->SetNumPositionStepsOverride( vjolt_precision_position_steps.GetInt() );
+}
+
+//-------------------------------------------------------------------------------------------------
+
+namespace
+{
+	// Only things that can move can be pushed around.
+	class RadialImpulseBroadPhaseLayerFilter final : public JPH::BroadPhaseLayerFilter
+	{
+	public:
+		bool ShouldCollide( JPH::BroadPhaseLayer inLayer ) const override
+		{
+			return inLayer == BroadPhaseLayers::MOVING || inLayer == BroadPhaseLayers::DEBRIS;
+		}
+	};
+
+	class RadialImpulseObjectLayerFilter final : public JPH::ObjectLayerFilter
+	{
+	public:
+		bool ShouldCollide( JPH::ObjectLayer inLayer ) const override
+		{
+			return inLayer == Layers::MOVING || inLayer == Layers::DEBRIS;
+		}
+	};
+}
+
+int JoltPhysicsEnvironment::ApplyRadialImpulse( const Vector &vecCenter, float flRadius, float flMagnitude, float flFalloff, CUtlVector< IPhysicsObject * > *pAffectedObjects )
+{
+	if ( flRadius <= 0.0f || flMagnitude == 0.0f )
+		return 0;
+
+	const JPH::Vec3 center = SourceToJolt::Distance( vecCenter );
+	const float flJoltRadius = SourceToJolt::Distance( flRadius );
+
+	RadialImpulseBroadPhaseLayerFilter broadPhaseFilter;
+	RadialImpulseObjectLayerFilter objectFilter;
+	JPH::AllHitCollisionCollector< JPH::CollideShapeBodyCollector > collector;
+	m_PhysicsSystem.GetBroadPhaseQuery().CollideSphere( center, flJoltRadius, collector, broadPhaseFilter, objectFilter );
+
+	const JPH::BodyLockInterfaceNoLock &bodyLockInterface = m_PhysicsSystem.GetBodyLockInterfaceNoLock();
+
+	JPH::BodyIDVector sleepingBodies;
+	int nAffected = 0;
+	for ( const JPH::BodyID &bodyID : collector.mHits )
+	{
+		JPH::Body *pBody = bodyLockInterface.TryGetBody( bodyID );
+		if ( !pBody || !pBody->IsDynamic() )
+			continue;
+
+		JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( pBody->GetUserData() );
+		if ( !pObject->IsMoveable() )
+			continue;
+
+		// The broadphase only gave us the bodies whose bounds are in the sphere,
+		// so fall off by the distance to the closest point on the bounds, but push
+		// away from the center of mass so nothing starts spinning.
+		const float flDistance = ( pBody->GetWorldSpaceBounds().GetClosestPoint( center ) - center ).Length();
+		if ( flDistance > flJoltRadius )
+			continue;
+
+		JPH::Vec3 direction = pBody->GetCenterOfMassPosition() - center;
+		direction = direction.IsNearZero() ? JPH::Vec3::sAxisZ() : direction.Normalized();
+
+		// Falloff is the exponent, 0 pushes everything the same, 1 is linear.
+		const float flImpulse = flMagnitude * powf( 1.0f - flDistance / flJoltRadius, Max( flFalloff, 0.0f ) );
+		pBody->AddImpulse( direction * SourceToJolt::Distance( flImpulse ) );
+
+		if ( !pBody->IsActive() )
+			sleepingBodies.push_back( bodyID );
+
+		if ( pAffectedObjects )
+			pAffectedObjects->AddToTail( pObject );
+
+		nAffected++;
+	}
+
+	// Wake everything we pushed in one go rather than one at a time.
+	if ( !sleepingBodies.empty() )
+		m_PhysicsSystem.GetBodyInterfaceNoLock().ActivateBodies( sleepingBodies.data(), int( sleepingBodies.size() ) );
+
+	return nAffected;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+JoltPhysicsEnvironmentExt JoltPhysicsEnvironmentExt::s_PhysicsEnvironmentExt;
+EXPOSE_SINGLE_INTERFACE_GLOBALVAR( JoltPhysicsEnvironmentExt, IJoltPhysicsEnvironmentExt, VJOLT_PHYSICS_ENVIRONMENT_EXT_INTERFACE_VERSION, JoltPhysicsEnvironmentExt::GetInstance() );
+
+int JoltPhysicsEnvironmentExt::ApplyRadialImpulse( IPhysicsEnvironment *pEnvironment, const Vector &vecCenter, float flRadius, float flMagnitude, float flFalloff, CUtlVector< IPhysicsObject * > *pAffectedObjects )
+{
+	// Every environment the game has came from our CreateEnvironment.
+	if ( !pEnvironment )
+		return 0;
+
+	return static_cast< JoltPhysicsEnvironment * >( pEnvironment )->ApplyRadialImpulse( vecCenter, flRadius, flMagnitude, flFalloff, pAffectedObjects );
+}
+
+//-------------------------------------------------------------------------------------------------
+
 void JoltPhysicsEnvironment::AddDirtyStaticBody( const JPH::BodyID &id )
 {
 	m_DirtyStaticBodies.push_back( id );
@@ -1423,6 +1852,73 @@ void JoltPhysicsEnvironment::RemoveDirtyStaticBody( const JPH::BodyID &id )
 
 //-------------------------------------------------------------------------------------------------
 
+void JoltPhysicsEnvironment::AddAlternateGravityObject( JoltPhysicsObject *pObject )
+{
+	m_pAlternateGravityObjects.push_back( pObject );
+}
+
+void JoltPhysicsEnvironment::RemoveAlternateGravityObject( JoltPhysicsObject *pObject )
+{
+	Erase( m_pAlternateGravityObjects, pObject );
+}
+
+void JoltPhysicsEnvironment::UpdateAlternateGravity()
+{
+	const JPH::Vec3 gravity = m_PhysicsSystem.GetGravity();
+	const float flGravityLengthSq = gravity.LengthSq();
+
+	m_flAlternateGravityFactor = flGravityLengthSq > 0.0f ? gravity.Dot( m_AlternateGravity ) / flGravityLengthSq : 0.0f;
+	m_AlternateGravityResidual = m_AlternateGravity - m_flAlternateGravityFactor * gravity;
+
+	// Don't bother with the step listener for tiny amounts of residual,
+	// the usual cases of zero or scaled gravity need none at all.
+	if ( m_AlternateGravityResidual.LengthSq() < 1e-8f )
+		m_AlternateGravityResidual = JPH::Vec3::sZero();
+
+	for ( JoltPhysicsObject *pObject : m_pAlternateGravityObjects )
+		pObject->UpdateGravity();
+}
+
+void JoltPhysicsEnvironment::ApplyAlternateGravityResidual( float flDeltaTime )
+{
+	if ( m_AlternateGravityResidual == JPH::Vec3::sZero() )
+		return;
+
+	const JPH::Vec3 deltaVelocity = m_AlternateGravityResidual * flDeltaTime;
+	for ( JoltPhysicsObject *pObject : m_pAlternateGravityObjects )
+	{
+		JPH::Body *pBody = pObject->GetBody();
+		if ( !pBody->IsActive() || !pBody->IsDynamic() || !pObject->IsGravityEnabled() )
+			continue;
+
+		JPH::MotionProperties *pMotionProperties = pBody->GetMotionProperties();
+		pMotionProperties->SetLinearVelocityClamped( pMotionProperties->GetLinearVelocity() + deltaVelocity );
+	}
+}
+
+void JoltAlternateGravityStepListener::OnStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem )
+{
+	m_pEnvironment->ApplyAlternateGravityResidual( flDeltaTime );
+}
+
+//-------------------------------------------------------------------------------------------------
+
+float JoltPhysicsEnvironment::GetNearestPlayerDistanceSq( JPH::Vec3Arg position )
+{
+	float flNearestDistanceSq = FLT_MAX;
+	for ( JoltPhysicsPlayerController *pController : m_pPlayerControllers )
+	{
+		JoltPhysicsObject *pObject = static_cast< JoltPhysicsObject * >( pController->GetObject() );
+		if ( !pObject )
+			continue;
+
+		flNearestDistanceSq = Min( flNearestDistanceSq, ( pObject->GetBody()->GetPosition() - position ).LengthSq() );
+	}
+	return flNearestDistanceSq;
+}
+
+//-------------------------------------------------------------------------------------------------
+
 void JoltPhysicsEnvironment::RemoveBodyAndDeleteObject( JoltPhysicsObject *pObject )
 {
 	JPH::BodyInterface &bodyInterface = m_PhysicsSystem.GetBodyInterfaceNoLock();
@@ -9,11 +9,14 @@
 #include "vjolt_interface.h"
 #include "vjolt_object.h"
 #include "vjolt_constraints.h"
+#include "vjolt_listener_activation.h"
 #include "vjolt_listener_contact.h"
 
 class JoltBroadPhaseLayerInterface;
 class JoltObjectVsBroadPhaseLayerFilter;
 class JoltObjectLayerPairFilter;
+class JoltPhysicsPlayerController;
+class JoltPhysicsVehicleController;
 
 // StateRecorder implementation that saves to a fixed buffer
 class VJoltStateRecorder final : public JPH::StateRecorder, public CUtlBuffer
@@ -39,6 +42,24 @@ public:
 	bool IsFailed() const override { return false; }
 };
 
+class JoltPhysicsEnvironment;
+
+// Applies whatever part of the alternate gravity that gravity factors
+// along the regular gravity can't, as part of each collision step.
+class JoltAlternateGravityStepListener final : public JPH::PhysicsStepListener
+{
+public:
+	JoltAlternateGravityStepListener( JoltPhysicsEnvironment *pEnvironment )
+		: m_pEnvironment( pEnvironment )
+	{
+	}
+
+	void OnStep( float flDeltaTime, JPH::PhysicsSystem &physicsSystem ) override;
+
+private:
+	JoltPhysicsEnvironment *m_pEnvironment;
+};
+
 class JoltPhysicsEnvironment final : public IPhysicsEnvironment
 {
 public:
@@ -158,6 +179,8 @@ public:
 public:
 	JPH::PhysicsSystem* GetPhysicsSystem() { return &m_PhysicsSystem; }
 
+	bool IsUsingLinearCast() const { return m_bUseLinearCast; }
+
 	void ObjectTransferHandOver( JoltPhysicsObject* pObject );
 
 	JoltPhysicsContactListener* GetContactListener() { return &m_ContactListener; }
@@ -166,9 +189,29 @@ public:
 
 	void NotifyConstraintDisabled( JoltPhysicsConstraint* pConstraint );
 
+	// Gives the islands this constraint is in more solver steps,
+	// for the things that need to be stable like vehicles and ragdolls.
+	void ApplyPrecisionStepsOverride( JPH::Constraint *pConstraint );
+
+	// The game gets at this through IJoltPhysicsEnvironmentExt.
+	int ApplyRadialImpulse( const Vector &vecCenter, float flRadius, float flMagnitude, float flFalloff, CUtlVector< IPhysicsObject * > *pAffectedObjects = nullptr );
+
 	void AddDirtyStaticBody( const JPH::BodyID &id );
 	void RemoveDirtyStaticBody( const JPH::BodyID &id );
 
+	void AddAlternateGravityObject( JoltPhysicsObject *pObject );
+	void RemoveAlternateGravityObject( JoltPhysicsObject *pObject );
+
+	// The gravity factor for objects using alternate gravity,
+	// this is the part of the alternate gravity along the regular gravity.
+	float GetAlternateGravityFactor() const { return m_flAlternateGravityFactor; }
+
+	void ApplyAlternateGravityResidual( float flDeltaTime );
+
+	// Squared distance in Jolt units from position to the closest player controlled object,
+	// or FLT_MAX if there are no players in this environment.
+	float GetNearestPlayerDistanceSq( JPH::Vec3Arg position );
+
 private:
 
 	void RemoveBodyAndDeleteObject( JoltPhysicsObject* pObject );
@@ -182,6 +225,8 @@ private:
 
 	void HandleDebugDumpingEnvironment( void* pReturnAddress );
 
+	void UpdateAlternateGravity();
+
 	bool m_bSimulating = false;
 	bool m_bEnableDeleteQueue = false;
 	bool m_bWakeObjectsOnConstraintDeletion = false;
@@ -200,6 +245,8 @@ private:
 
 	// For GetActiveObjectCount and GetActiveObjects
 	mutable JPH::BodyIDVector m_CachedActiveBodies;
+	// Vehicle wheels have no bodies, so get tacked on the end of the active bodies.
+	mutable std::vector< IPhysicsObject * > m_CachedActiveWheels;
 
 	JPH::PhysicsSystem m_PhysicsSystem;
 
@@ -216,6 +263,16 @@ private:
 	std::vector< CPhysCollide * > m_pDeadObjectCollides;
 
 	std::vector< IJoltPhysicsController * > m_pPhysicsControllers;
+	std::vector< JoltPhysicsPlayerController * > m_pPlayerControllers;
+	std::vector< JoltPhysicsVehicleController * > m_pVehicleControllers;
+
+	// Alternate gravity is split into a gravity factor along the regular gravity, which Jolt
+	// integrates for free, and whatever is left over which gets added in a step listener.
+	JPH::Vec3 m_AlternateGravity = JPH::Vec3::sZero();
+	float m_flAlternateGravityFactor = 0.0f;
+	JPH::Vec3 m_AlternateGravityResidual = JPH::Vec3::sZero();
+	std::vector< JoltPhysicsObject * > m_pAlternateGravityObjects;
+	JoltAlternateGravityStepListener m_AlternateGravityListener{ this };
 
 	std::unordered_map< uintp, void * > m_SaveRestorePointerMap;
 
@@ -224,11 +281,28 @@ private:
 	IVJoltDebugOverlay *m_pDebugOverlay = nullptr;
 
 	JoltPhysicsContactListener m_ContactListener;
+	JoltPhysicsActivationListener m_ActivationListener;
 	IPhysicsConstraintEvent *m_pConstraintListener = nullptr;
 
 	bool m_EnableConstraintNotify = false;
 
 	mutable bool m_bActiveObjectCountFirst = true;
 
+	// Time since DebugCheckContacts was last run by vjolt_debugcheckcontacts_interval
+	float m_flDebugCheckContactsTime = 0.0f;
+
 	physics_performanceparams_t m_PerformanceParams;
 };
+
+//-------------------------------------------------------------------------------------------------
+
+class JoltPhysicsEnvironmentExt final : public IJoltPhysicsEnvironmentExt
+{
+public:
+	int ApplyRadialImpulse( IPhysicsEnvironment *pEnvironment, const Vector &vecCenter, float flRadius, float flMagnitude, float flFalloff, CUtlVector< IPhysicsObject * > *pAffectedObjects ) override;
+
+	static JoltPhysicsEnvironmentExt& GetInstance() { return s_PhysicsEnvironmentExt; }
+
+private:
+	static JoltPhysicsEnvironmentExt s_PhysicsEnvironmentExt;
+};
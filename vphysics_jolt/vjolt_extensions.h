@@ -0,0 +1,49 @@
+//=================================================================================================
+//
+// Extensions on top of the stock VPhysics interfaces
+//
+// The game can't see any of our classes, so anything we offer beyond IPhysics* goes
+// through one of these. They only depend on the public SDK headers, so this file
+// can be dropped into the game as is. Get them from the physics interface, eg:
+//
+//   auto *pCollisionExt = (IJoltPhysicsCollisionExt *)physics->QueryInterface( VJOLT_PHYSICS_COLLISION_EXT_INTERFACE_VERSION );
+//
+// They are null when running on any other physics DLL, so always check.
+//
+//=================================================================================================
+
+#pragma once
+
+#include "tier1/utlvector.h"
+
+class Vector;
+struct truncatedcone_t;
+class IPhysicsEnvironment;
+class IPhysicsObject;
+
+//-------------------------------------------------------------------------------------------------
+
+abstract_class IJoltPhysicsCollisionExt
+{
+public:
+	// Tests many boxes against the same cone, writing whether each one intersects into
+	// pOutResults and returning how many did.
+	virtual int AreBoxesIntersectingCone( const Vector *pBoxAbsMins, const Vector *pBoxAbsMaxs, int nBoxCount, const truncatedcone_t &cone, bool *pOutResults ) = 0;
+};
+
+#define VJOLT_PHYSICS_COLLISION_EXT_INTERFACE_VERSION "VJoltPhysicsCollisionExt001"
+
+//-------------------------------------------------------------------------------------------------
+
+// Environments have no QueryInterface of their own, so this takes the environment to work on.
+abstract_class IJoltPhysicsEnvironmentExt
+{
+public:
+	// Pushes every moveable object in the radius away from the center, for explosions.
+	// Magnitude is the impulse at the center in kg * in/s, falloff is the exponent it drops off
+	// towards the edge with. Optionally gives back the objects that got pushed for game side damage.
+	// Returns the number of objects that got pushed.
+	virtual int ApplyRadialImpulse( IPhysicsEnvironment *pEnvironment, const Vector &vecCenter, float flRadius, float flMagnitude, float flFalloff, CUtlVector< IPhysicsObject * > *pAffectedObjects ) = 0;
+};
+
+#define VJOLT_PHYSICS_ENVIRONMENT_EXT_INTERFACE_VERSION "VJoltPhysicsEnvironmentExt001"
@@ -13,7 +13,7 @@
 const JoltKVSchemaFunc_t FillBaseProp =
 {
 	sizeof( surfacedata_t ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		surfacedata_t *pSurfaceDataPtr = reinterpret_cast< surfacedata_t * >( pPtr );
 
@@ -32,7 +32,7 @@ const JoltKVSchemaFunc_t FillBaseProp =
 const JoltKVSchemaFunc_t FillStringProp =
 {
 	0, // Varies.
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		char *pszStringPtr = reinterpret_cast< char * >( pPtr );
 		V_strncpy( pszStringPtr, pProp->GetString(), static_cast< strlen_t >( size ) );
@@ -42,7 +42,7 @@ const JoltKVSchemaFunc_t FillStringProp =
 const JoltKVSchemaFunc_t FillIntProp =
 {
 	sizeof( int ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		int *pIntPtr = reinterpret_cast< int * >( pPtr );
 		*pIntPtr = pProp->GetInt();
@@ -52,7 +52,7 @@ const JoltKVSchemaFunc_t FillIntProp =
 const JoltKVSchemaFunc_t FillFloatProp =
 {
 	sizeof( float ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		float *pFloatPtr = reinterpret_cast< float * >( pPtr );
 		*pFloatPtr = pProp->GetFloat();
@@ -62,7 +62,7 @@ const JoltKVSchemaFunc_t FillFloatProp =
 const JoltKVSchemaFunc_t FillUnsignedCharProp =
 {
 	sizeof( unsigned char ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		unsigned char *pCharPtr = reinterpret_cast< unsigned char * >( pPtr );
 		*pCharPtr = static_cast< unsigned char >( pProp->GetInt() );
@@ -72,7 +72,7 @@ const JoltKVSchemaFunc_t FillUnsignedCharProp =
 const JoltKVSchemaFunc_t FillBoolProp =
 {
 	sizeof( bool ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		bool *pBoolPtr = reinterpret_cast< bool * >( pPtr );
 		*pBoolPtr = pProp->GetBool();
@@ -82,47 +82,53 @@ const JoltKVSchemaFunc_t FillBoolProp =
 const JoltKVSchemaFunc_t FillVectorProp =
 {
 	sizeof( Vector ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		Vector *pVectorPtr = reinterpret_cast< Vector * >( pPtr );
-		sscanf( pProp->GetString(), "%f %f %f", &pVectorPtr->x, &pVectorPtr->y, &pVectorPtr->z );
+		const char *pszCursor = pProp->GetString();
+		JoltKVParseFloat( pszCursor, pVectorPtr->x ) && JoltKVParseFloat( pszCursor, pVectorPtr->y ) && JoltKVParseFloat( pszCursor, pVectorPtr->z );
 	}
 };
 
 const JoltKVSchemaFunc_t FillVector4DProp =
 {
 	sizeof( Vector4D ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		Vector4D *pVector4DPtr = reinterpret_cast< Vector4D * >( pPtr );
-		sscanf( pProp->GetString(), "%f %f %f %f", &pVector4DPtr->x, &pVector4DPtr->y, &pVector4DPtr->z, &pVector4DPtr->w );
+		const char *pszCursor = pProp->GetString();
+		JoltKVParseFloat( pszCursor, pVector4DPtr->x ) && JoltKVParseFloat( pszCursor, pVector4DPtr->y ) &&
+		JoltKVParseFloat( pszCursor, pVector4DPtr->z ) && JoltKVParseFloat( pszCursor, pVector4DPtr->w );
 	}
 };
 
 const JoltKVSchemaFunc_t FillQAngleProp =
 {
 	sizeof( QAngle ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		QAngle *pQAnglePtr = reinterpret_cast< QAngle * >( pPtr );
-		sscanf( pProp->GetString(), "%f %f %f", &pQAnglePtr->x, &pQAnglePtr->y, &pQAnglePtr->z );
+		const char *pszCursor = pProp->GetString();
+		JoltKVParseFloat( pszCursor, pQAnglePtr->x ) && JoltKVParseFloat( pszCursor, pQAnglePtr->y ) && JoltKVParseFloat( pszCursor, pQAnglePtr->z );
 	}
 };
 
 const JoltKVSchemaFunc_t FillIntPairProp =
 {
 	sizeof( JoltPhysicsIntPair ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		JoltPhysicsIntPair *pIntPairPtr = reinterpret_cast< JoltPhysicsIntPair * >( pPtr );
-		sscanf( pProp->GetString(), "%d,%d", &pIntPairPtr->Index0, &pIntPairPtr->Index1 );
+		const char *pszCursor = pProp->GetString();
+		if ( JoltKVParseInt( pszCursor, pIntPairPtr->Index0 ) && *pszCursor++ == ',' )
+			JoltKVParseInt( pszCursor, pIntPairPtr->Index1 );
 	}
 };
 
 const JoltKVSchemaFunc_t FillGameMaterialProp =
 {
 	sizeof( unsigned short ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		const char *pValue = pProp->GetString();
 		unsigned short *pShortPtr = reinterpret_cast< unsigned short * >( pPtr );
@@ -137,7 +143,7 @@ const JoltKVSchemaFunc_t FillGameMaterialProp =
 const JoltKVSchemaFunc_t FillSoundProp =
 {
 	sizeof( unsigned short ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		const char *pValue = pProp->GetString();
 		unsigned short *pShortPtr = reinterpret_cast< unsigned short * >( pPtr );
@@ -149,7 +155,7 @@ const JoltKVSchemaFunc_t FillSoundProp =
 const JoltKVSchemaFunc_t FillSurfaceProp =
 {
 	sizeof( int ),
-	[]( KeyValues *pProp, void *pPtr, size_t size )
+	[]( JoltKVProp *pProp, void *pPtr, size_t size )
 	{
 		const char* pValue = pProp->GetString();
 		int *pIntPtr = reinterpret_cast< int * >( pPtr );
@@ -160,21 +166,40 @@ const JoltKVSchemaFunc_t FillSurfaceProp =
 
 //-------------------------------------------------------------------------------------------------
 
-void ParseJoltKVSchema( KeyValues *pKV, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, void *pUnknownKeyObj, IVPhysicsKeyHandler *pUnknownKeyHandler )
+static thread_local JoltKVSchemaWriteRecorder *s_pSchemaWriteRecorder = nullptr;
+static thread_local uint s_nSchemaParses = 0;
+
+JoltKVSchemaWriteRecorder::JoltKVSchemaWriteRecorder( const void *pBaseObject )
+	: m_pBaseObject( reinterpret_cast< const char * >( pBaseObject ) )
+	, m_pPrevious( s_pSchemaWriteRecorder )
+{
+	s_pSchemaWriteRecorder = this;
+}
+
+JoltKVSchemaWriteRecorder::~JoltKVSchemaWriteRecorder()
 {
-	bool bHandled = false;
+	s_pSchemaWriteRecorder = m_pPrevious;
+}
 
-    for ( KeyValues* pProp = pKV->GetFirstSubKey(); pProp != nullptr; pProp = pProp->GetNextKey() )
-    {
-        const char *pName = pProp->GetName();
-        
-        for ( uint i = 0; i < count; i++ )
-        {
-            const JoltKVSchemaProp_t &desc = pDescs[ i ];
+//-------------------------------------------------------------------------------------------------
 
-            if ( !V_stricmp( pName, desc.pszName ) )
-            {
-                VJoltAssertMsg( desc.func.ptr_size == 0 || desc.size == desc.func.ptr_size, "Desc element size does not match function size");
+void ParseJoltKVSchema( JoltKVProp *pKV, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, void *pUnknownKeyObj, IVPhysicsKeyHandler *pUnknownKeyHandler )
+{
+	s_nSchemaParses++;
+
+	JoltKVProp prop;
+	while ( pKV->NextSubKey( &prop ) )
+	{
+		const char *pName = prop.GetName();
+		bool bHandled = false;
+
+		for ( uint i = 0; i < count; i++ )
+		{
+			const JoltKVSchemaProp_t &desc = pDescs[ i ];
+
+			if ( !V_stricmp( pName, desc.pszName ) )
+			{
+				VJoltAssertMsg( desc.func.ptr_size == 0 || desc.size == desc.func.ptr_size, "Desc element size does not match function size");
 
 				int *pArraySize = nullptr;
 				if ( desc.arrayOffset != static_cast<size_t>( ~0llu ) )
@@ -184,32 +209,49 @@ void ParseJoltKVSchema( KeyValues *pKV, const JoltKVSchemaProp_t *pDescs, uint c
 				if ( pArraySize )
 					pElement += *pArraySize * desc.size;
 
-                desc.func.ReadFunc( pProp, reinterpret_cast< void * >( pElement ), desc.size);
+				const uint nParsesBefore = s_nSchemaParses;
+				desc.func.ReadFunc( &prop, reinterpret_cast< void * >( pElement ), desc.size);
 				if ( desc.fixupFunc )
 					desc.fixupFunc( pObj );
 				if ( pArraySize )
 					( *pArraySize )++;
 				bHandled = true;
-            }
-        }
+
+				if ( JoltKVSchemaWriteRecorder *pRecorder = s_pSchemaWriteRecorder )
+				{
+					if ( pArraySize )
+					{
+						const size_t nCountOffset = size_t( reinterpret_cast< char * >( pArraySize ) - pRecorder->m_pBaseObject );
+						pRecorder->m_Reads.emplace_back( nCountOffset, sizeof( int ) );
+						pRecorder->m_Writes.emplace_back( nCountOffset, sizeof( int ) );
+					}
+
+					// Blocks that parse their own schema record the fields inside them themselves,
+					// only the whole element gets written by everything else.
+					if ( s_nSchemaParses == nParsesBefore )
+						pRecorder->m_Writes.emplace_back( size_t( pElement - pRecorder->m_pBaseObject ), desc.size );
+				}
+			}
+		}
 
 		if ( !bHandled && pUnknownKeyHandler )
-			pUnknownKeyHandler->ParseKeyValue( pUnknownKeyObj, pName, pProp->GetString() );
-    }
+			pUnknownKeyHandler->ParseKeyValue( pUnknownKeyObj, pName, prop.GetString() );
+	}
 }
 
-void ParseJoltKVCustom( KeyValues *pKV, void *pUnknownKeyObj, IVPhysicsKeyHandler* pUnknownKeyHandler )
+void ParseJoltKVCustom( JoltKVProp *pKV, void *pUnknownKeyObj, IVPhysicsKeyHandler* pUnknownKeyHandler )
 {
 	// Josh:
 	// Parse out custom KV entries like "vehicle_sounds" etc
 	// out recursively.
 
-	for ( KeyValues* pProp = pKV->GetFirstSubKey(); pProp != nullptr; pProp = pProp->GetNextKey() )
+	JoltKVProp prop;
+	while ( pKV->NextSubKey( &prop ) )
 	{
 		if ( pUnknownKeyHandler )
-			pUnknownKeyHandler->ParseKeyValue( pUnknownKeyObj, pProp->GetName(), pProp->GetString());
+			pUnknownKeyHandler->ParseKeyValue( pUnknownKeyObj, prop.GetName(), prop.GetString() );
 
-		ParseJoltKVCustom( pProp, pUnknownKeyObj, pUnknownKeyHandler );
+		ParseJoltKVCustom( &prop, pUnknownKeyObj, pUnknownKeyHandler );
 	}
 }
 
@@ -236,3 +278,421 @@ KeyValues *HeaderlessKVBufferToKeyValues( const char *pszBuffer, const char *psz
 
 	return pszKV;
 }
+
+//-------------------------------------------------------------------------------------------------
+
+static bool IsKVWhitespace( char c )
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static bool IsKVDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+bool JoltKVParseFloat( const char *&pszCursor, float &flOut )
+{
+	// Powers of ten that are exactly representable as a double.
+	static constexpr double kPowersOfTen[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+	static constexpr int kMaxExactPower = int( std::size( kPowersOfTen ) ) - 1;
+	// We can't hold any more significant digits than this in a uint64.
+	static constexpr int kMaxMantissaDigits = 19;
+
+	const char *p = pszCursor;
+	while ( IsKVWhitespace( *p ) )
+		p++;
+
+	bool bNegative = false;
+	if ( *p == '-' || *p == '+' )
+		bNegative = *p++ == '-';
+
+	uint64 uMantissa = 0;
+	int nMantissaDigits = 0;
+	int nExponent = 0;
+	bool bAnyDigits = false;
+
+	for ( ; IsKVDigit( *p ); p++ )
+	{
+		bAnyDigits = true;
+		if ( nMantissaDigits < kMaxMantissaDigits )
+		{
+			uMantissa = uMantissa * 10 + uint64( *p - '0' );
+			if ( uMantissa )
+				nMantissaDigits++;
+		}
+		else
+			nExponent++;
+	}
+
+	if ( *p == '.' )
+	{
+		for ( p++; IsKVDigit( *p ); p++ )
+		{
+			bAnyDigits = true;
+			if ( nMantissaDigits < kMaxMantissaDigits )
+			{
+				uMantissa = uMantissa * 10 + uint64( *p - '0' );
+				if ( uMantissa )
+					nMantissaDigits++;
+				nExponent--;
+			}
+		}
+	}
+
+	if ( !bAnyDigits )
+		return false;
+
+	if ( *p == 'e' || *p == 'E' )
+	{
+		const char *pExponent = p + 1;
+
+		bool bNegativeExponent = false;
+		if ( *pExponent == '-' || *pExponent == '+' )
+			bNegativeExponent = *pExponent++ == '-';
+
+		if ( IsKVDigit( *pExponent ) )
+		{
+			int nExplicitExponent = 0;
+			for ( ; IsKVDigit( *pExponent ); pExponent++ )
+				nExplicitExponent = Min( nExplicitExponent * 10 + ( *pExponent - '0' ), 1000 );
+
+			nExponent += bNegativeExponent ? -nExplicitExponent : nExplicitExponent;
+			p = pExponent;
+		}
+	}
+
+	double flValue = double( uMantissa );
+	if ( uMantissa )
+	{
+		for ( ; nExponent > kMaxExactPower; nExponent -= kMaxExactPower )
+			flValue *= kPowersOfTen[ kMaxExactPower ];
+		for ( ; nExponent < -kMaxExactPower; nExponent += kMaxExactPower )
+			flValue /= kPowersOfTen[ kMaxExactPower ];
+
+		flValue = nExponent >= 0
+			? flValue * kPowersOfTen[ nExponent ]
+			: flValue / kPowersOfTen[ -nExponent ];
+	}
+
+	flOut = float( bNegative ? -flValue : flValue );
+	pszCursor = p;
+	return true;
+}
+
+bool JoltKVParseInt( const char *&pszCursor, int &nOut )
+{
+	const char *p = pszCursor;
+	while ( IsKVWhitespace( *p ) )
+		p++;
+
+	bool bNegative = false;
+	if ( *p == '-' || *p == '+' )
+		bNegative = *p++ == '-';
+
+	if ( !IsKVDigit( *p ) )
+		return false;
+
+	int64 nValue = 0;
+	for ( ; IsKVDigit( *p ); p++ )
+		nValue = Min< int64 >( nValue * 10 + ( *p - '0' ), INT_MAX );
+
+	nOut = int( bNegative ? -nValue : nValue );
+	pszCursor = p;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+JoltKVProp::JoltKVProp()
+{
+	m_szName[ 0 ] = '\0';
+	m_szValue[ 0 ] = '\0';
+}
+
+int JoltKVProp::GetInt() const
+{
+	const char *pszCursor = m_szValue;
+	int nValue = 0;
+	JoltKVParseInt( pszCursor, nValue );
+	return nValue;
+}
+
+float JoltKVProp::GetFloat() const
+{
+	const char *pszCursor = m_szValue;
+	float flValue = 0.0f;
+	JoltKVParseFloat( pszCursor, flValue );
+	return flValue;
+}
+
+bool JoltKVProp::NextSubKey( JoltKVProp *pSubKey )
+{
+	if ( !m_bBlock || m_bFinished )
+		return false;
+
+	JoltKVReader *pReader = m_pReader;
+
+	// Keep going until we find a key whose conditionals are true for this platform,
+	// like KeyValues we just drop the ones that aren't.
+	for ( ;; )
+	{
+		// Skip the rest of whatever sub-block we handed out last,
+		// if it wasn't read all the way through.
+		if ( !pReader->SkipToDepth( m_nDepth ) )
+		{
+			m_bFinished = true;
+			return false;
+		}
+
+		switch ( pReader->ReadToken( pSubKey->m_szName ) )
+		{
+			case JoltKVReader::Token::String:
+				break;
+
+			case JoltKVReader::Token::OpenBrace:
+				pReader->Fail( "block without a name" );
+				m_bFinished = true;
+				return false;
+
+			case JoltKVReader::Token::CloseBrace:
+				if ( m_nDepth == 0 )
+					pReader->Fail( "unbalanced '}'" );
+				m_bFinished = true;
+				return false;
+
+			default:
+				if ( m_nDepth != 0 )
+					pReader->Fail( "unexpected end of buffer" );
+				m_bFinished = true;
+				return false;
+		}
+
+		pSubKey->m_pReader		= pReader;
+		pSubKey->m_bFinished	= false;
+
+		// "key" [$X360] { ... } or "key" [$X360] "value"
+		const bool bNameCondition = pReader->ReadConditional();
+
+		switch ( pReader->ReadToken( pSubKey->m_szValue ) )
+		{
+			case JoltKVReader::Token::String:
+				pSubKey->m_bBlock = false;
+				pSubKey->m_nDepth = m_nDepth;
+
+				// "key" "value" [$X360]
+				if ( !pReader->ReadConditional() || !bNameCondition )
+					continue;
+
+				return true;
+
+			case JoltKVReader::Token::OpenBrace:
+				pSubKey->m_szValue[ 0 ] = '\0';
+				pSubKey->m_bBlock = true;
+				pSubKey->m_nDepth = pReader->m_nDepth;
+
+				// The block gets skipped by SkipToDepth at the top.
+				if ( !bNameCondition )
+					continue;
+
+				return true;
+
+			default:
+				pReader->Fail( "key without a value" );
+				m_bFinished = true;
+				return false;
+		}
+	}
+}
+
+void JoltKVProp::Skip()
+{
+	if ( !m_bBlock || m_bFinished )
+		return;
+
+	m_pReader->SkipToDepth( m_nDepth - 1 );
+	m_bFinished = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+JoltKVReader::JoltKVReader( const char *pszBuffer )
+{
+	Init( pszBuffer );
+}
+
+void JoltKVReader::Init( const char *pszBuffer )
+{
+	// Skip the UTF-8 BOM if there is one.
+	if ( pszBuffer && V_strncmp( pszBuffer, "\xEF\xBB\xBF", 3 ) == 0 )
+		pszBuffer += 3;
+
+	m_pszCursor	= pszBuffer ? pszBuffer : "";
+	m_nDepth	= 0;
+	m_bFailed	= false;
+
+	m_Root.m_pReader	= this;
+	m_Root.m_nDepth		= 0;
+	m_Root.m_bBlock		= true;
+	m_Root.m_bFinished	= false;
+}
+
+// Matches KeyValues' EvaluateConditional.
+static bool EvaluateKVConditional( const char *pszConditional )
+{
+	const bool bNot = pszConditional[ 0 ] == '!';
+
+	if ( V_stristr( pszConditional, "$X360" ) )
+		return IsX360() ^ bNot;
+
+	if ( V_stristr( pszConditional, "$WIN32" ) )
+		return IsPC() ^ bNot; // WIN32 really means IsPC here, same as KeyValues.
+
+	if ( V_stristr( pszConditional, "$WINDOWS" ) )
+		return IsWindows() ^ bNot;
+
+	if ( V_stristr( pszConditional, "$OSX" ) )
+		return IsOSX() ^ bNot;
+
+	if ( V_stristr( pszConditional, "$LINUX" ) )
+		return IsLinux() ^ bNot;
+
+	if ( V_stristr( pszConditional, "$POSIX" ) )
+		return IsPosix() ^ bNot;
+
+	return false;
+}
+
+void JoltKVReader::SkipWhitespaceAndComments()
+{
+	const char *p = m_pszCursor;
+	for ( ;; )
+	{
+		while ( IsKVWhitespace( *p ) )
+			p++;
+
+		// Comments
+		if ( p[ 0 ] == '/' && p[ 1 ] == '/' )
+		{
+			while ( *p && *p != '\n' )
+				p++;
+			continue;
+		}
+
+		break;
+	}
+	m_pszCursor = p;
+}
+
+bool JoltKVReader::ReadConditional()
+{
+	if ( m_bFailed )
+		return true;
+
+	SkipWhitespaceAndComments();
+
+	const char *p = m_pszCursor;
+	if ( *p != '[' )
+		return true;
+
+	const char *pStart = ++p;
+	while ( *p && *p != ']' && *p != '\n' )
+		p++;
+
+	char szConditional[ 64 ];
+	V_strncpy( szConditional, pStart, Min< int >( int( p - pStart ) + 1, sizeof( szConditional ) ) );
+
+	if ( *p == ']' )
+		p++;
+	m_pszCursor = p;
+
+	return EvaluateKVConditional( szConditional );
+}
+
+JoltKVReader::Token JoltKVReader::ReadToken( char *pszOut )
+{
+	if ( m_bFailed )
+		return Token::End;
+
+	SkipWhitespaceAndComments();
+
+	// Conditionals are only meaningful after a key or value, where
+	// ReadConditional picks them up. Skip any stray ones like KeyValues does.
+	while ( *m_pszCursor == '[' )
+	{
+		ReadConditional();
+		SkipWhitespaceAndComments();
+	}
+
+	const char *p = m_pszCursor;
+
+	if ( !*p )
+	{
+		m_pszCursor = p;
+		return Token::End;
+	}
+
+	if ( *p == '{' || *p == '}' )
+	{
+		const bool bOpen = *p == '{';
+		m_nDepth += bOpen ? 1 : -1;
+		m_pszCursor = p + 1;
+		return bOpen ? Token::OpenBrace : Token::CloseBrace;
+	}
+
+	const char *pStart;
+	const char *pEnd;
+	if ( *p == '"' )
+	{
+		pStart = ++p;
+		while ( *p && *p != '"' )
+			p++;
+		pEnd = p;
+		if ( *p == '"' )
+			p++;
+	}
+	else
+	{
+		pStart = p;
+		while ( *p && !IsKVWhitespace( *p ) && *p != '"' && *p != '{' && *p != '}' )
+			p++;
+		pEnd = p;
+	}
+
+	if ( pszOut )
+	{
+		const size_t nLength = Min< size_t >( size_t( pEnd - pStart ), JoltKVProp::kMaxTokenLength - 1 );
+		V_memcpy( pszOut, pStart, nLength );
+		pszOut[ nLength ] = '\0';
+	}
+
+	m_pszCursor = p;
+	return Token::String;
+}
+
+bool JoltKVReader::SkipToDepth( int nDepth )
+{
+	while ( m_nDepth > nDepth )
+	{
+		if ( ReadToken( nullptr ) == Token::End )
+		{
+			Fail( "unexpected end of buffer" );
+			return false;
+		}
+	}
+
+	return !m_bFailed && m_nDepth == nDepth;
+}
+
+void JoltKVReader::Fail( const char *pszReason )
+{
+	if ( m_bFailed )
+		return;
+
+	Log_Warning( LOG_VJolt, "Malformed KeyValues data: %s.\n", pszReason );
+	m_bFailed = true;
+}
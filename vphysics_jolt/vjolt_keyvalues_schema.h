@@ -1,6 +1,95 @@
 
 #pragma once
 
+class JoltKVReader;
+
+//-------------------------------------------------------------------------------------------------
+
+// A single key or block read out of a JoltKVReader.
+// The name and value are copied into fixed storage on the prop itself so that
+// these can live on the stack, and nothing gets allocated while parsing.
+class JoltKVProp
+{
+public:
+	static constexpr int kMaxTokenLength = 1024;
+
+	JoltKVProp();
+
+	const char *	GetName() const		{ return m_szName; }
+	const char *	GetString() const	{ return m_szValue; }
+	int				GetInt() const;
+	float			GetFloat() const;
+	bool			GetBool() const		{ return GetInt() != 0; }
+
+	bool			IsBlock() const		{ return m_bBlock; }
+
+	// Reads the next key of this block into pSubKey, skipping over anything
+	// left unread in the previous one. Returns false at the end of the block.
+	bool			NextSubKey( JoltKVProp *pSubKey );
+
+	// Skips over whatever is left of this block.
+	void			Skip();
+
+private:
+	friend class JoltKVReader;
+
+	JoltKVReader	*m_pReader = nullptr;
+	int				m_nDepth = 0;
+	bool			m_bBlock = false;
+	bool			m_bFinished = false;
+
+	char			m_szName[ kMaxTokenLength ];
+	char			m_szValue[ kMaxTokenLength ];
+};
+
+// Single-pass tokenizer over headerless KeyValues text, the format used by
+// .phy key data and surfaceproperties files.
+//
+// This never builds a KeyValues tree, the schema tables below get
+// filled directly as we walk the buffer. The buffer must outlive the reader.
+class JoltKVReader
+{
+public:
+	JoltKVReader( const char *pszBuffer = "" );
+
+	void		Init( const char *pszBuffer );
+
+	// The implicit block that wraps the whole buffer.
+	JoltKVProp *GetRoot()			{ return &m_Root; }
+	bool		IsFailed() const	{ return m_bFailed; }
+
+	// Where the next token will be read from.
+	const char *GetCursor() const	{ return m_pszCursor; }
+
+private:
+	friend class JoltKVProp;
+
+	enum class Token
+	{
+		String,
+		OpenBrace,
+		CloseBrace,
+		End,
+	};
+
+	// pszOut is kMaxTokenLength in size, or nullptr to discard the token.
+	Token		ReadToken( char *pszOut );
+	// Reads a conditional like [$WIN32] if there is one next, and returns
+	// whether it is true for this platform. True if there isn't one.
+	bool		ReadConditional();
+	void		SkipWhitespaceAndComments();
+	bool		SkipToDepth( int nDepth );
+	void		Fail( const char *pszReason );
+
+	const char	*m_pszCursor = nullptr;
+	int			m_nDepth = 0;
+	bool		m_bFailed = false;
+
+	JoltKVProp	m_Root;
+};
+
+//-------------------------------------------------------------------------------------------------
+
 // This function fixes up the base object
 // after loading a single KV value.
 using JoltKVSchemaFixupFunc_t = void (*)( void *pBaseObject );
@@ -8,7 +97,7 @@ using JoltKVSchemaFixupFunc_t = void (*)( void *pBaseObject );
 struct JoltKVSchemaFunc_t
 {
 	size_t ptr_size;
-	void ( *ReadFunc )( KeyValues *pProp, void *pPtr, size_t size );
+	void ( *ReadFunc )( JoltKVProp *pProp, void *pPtr, size_t size );
 };
 
 struct JoltKVSchemaProp_t
@@ -51,6 +140,35 @@ extern const JoltKVSchemaFunc_t FillSoundProp;
 #define KVSCHEMA_DESC_NO_OFFSET( type ) \
 	0, sizeof( type ), static_cast<size_t>(~0llu)
 
-void ParseJoltKVSchema( KeyValues *pKV, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, void *pUnknownKeyObj = nullptr, IVPhysicsKeyHandler* pUnknownKeyHandler = nullptr );
-void ParseJoltKVCustom( KeyValues *pKV, void *pUnknownKeyObj, IVPhysicsKeyHandler* pUnknownKeyHandler );
+void ParseJoltKVSchema( JoltKVProp *pKV, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, void *pUnknownKeyObj = nullptr, IVPhysicsKeyHandler* pUnknownKeyHandler = nullptr );
+
+// While one of these is alive, every ParseJoltKVSchema on this thread (including nested ones)
+// notes down which bytes of the object it wrote, and which ones it had to read to work out
+// where to write (the array counts). Offsets are relative to the object passed in.
+class JoltKVSchemaWriteRecorder
+{
+public:
+	using Range = std::pair< size_t, size_t >; // Offset, size
+
+	JoltKVSchemaWriteRecorder( const void *pBaseObject );
+	~JoltKVSchemaWriteRecorder();
+
+	const std::vector< Range > &GetWrites() const	{ return m_Writes; }
+	const std::vector< Range > &GetReads() const	{ return m_Reads; }
+
+private:
+	friend void ParseJoltKVSchema( JoltKVProp *pKV, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, void *pUnknownKeyObj, IVPhysicsKeyHandler* pUnknownKeyHandler );
+
+	const char					*m_pBaseObject = nullptr;
+	JoltKVSchemaWriteRecorder	*m_pPrevious = nullptr;
+
+	std::vector< Range >		m_Writes;
+	std::vector< Range >		m_Reads;
+};
+void ParseJoltKVCustom( JoltKVProp *pKV, void *pUnknownKeyObj, IVPhysicsKeyHandler* pUnknownKeyHandler );
 KeyValues *HeaderlessKVBufferToKeyValues( const char *pszBuffer, const char *pszSetName );
+
+// Locale-independent number parsing, used instead of sscanf/atof.
+// Advance pszCursor past the number and only write the output on success.
+bool JoltKVParseFloat( const char *&pszCursor, float &flOut );
+bool JoltKVParseInt( const char *&pszCursor, int &nOut );
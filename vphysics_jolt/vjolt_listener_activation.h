@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vjolt_listener_contact.h" // JoltPhysicsEventTracker
+
+class JoltPhysicsActivationListener final : public JPH::BodyActivationListener
+{
+public:
+	JoltPhysicsActivationListener( JPH::PhysicsSystem &physicsSystem )
+		: m_PhysicsSystem( physicsSystem )
+	{
+	}
+
+	// These are called from jobs, and sometimes with the body locked, so all we can
+	// do is remember which bodies changed. We work out whether they are actually
+	// awake or asleep when we flush, which means a body waking and going back to
+	// sleep within the same step sends nothing, and duplicates fall out for free.
+	void OnBodyActivated( const JPH::BodyID &inBodyID, JPH::uint64 inBodyUserData ) override
+	{
+		if ( m_pGameListener )
+			m_ActivationEvents.EmplaceBack( JoltPhysicsContactListener::GetThreadId(), inBodyID );
+	}
+
+	void OnBodyDeactivated( const JPH::BodyID &inBodyID, JPH::uint64 inBodyUserData ) override
+	{
+		if ( m_pGameListener )
+			m_ActivationEvents.EmplaceBack( JoltPhysicsContactListener::GetThreadId(), inBodyID );
+	}
+
+	IPhysicsObjectEvent *GetGameListener()
+	{
+		return m_pGameListener;
+	}
+
+	void SetGameListener( IPhysicsObjectEvent *pListener )
+	{
+		m_pGameListener = pListener;
+	}
+
+	void FlushCallbacks()
+	{
+		// Grab everything first, the game can wake things from inside the callbacks.
+		m_ActivationEvents.ForEach< true >( [ this ]( const JPH::BodyID &bodyID )
+		{
+			m_FlushBodies.push_back( bodyID );
+		});
+
+		if ( m_pGameListener )
+		{
+			const JPH::BodyLockInterfaceNoLock &bodyInterface = m_PhysicsSystem.GetBodyLockInterfaceNoLock();
+
+			for ( const JPH::BodyID &bodyID : m_FlushBodies )
+			{
+				// The body may have been destroyed since.
+				JPH::Body *pBody = bodyInterface.TryGetBody( bodyID );
+				if ( !pBody )
+					continue;
+
+				JoltPhysicsObject *pObject = reinterpret_cast< JoltPhysicsObject * >( pBody->GetUserData() );
+				const bool bAwake = pBody->IsActive();
+				if ( !pObject || pObject->WasReportedAwake() == bAwake )
+					continue;
+
+				pObject->SetReportedAwake( bAwake );
+				if ( bAwake )
+					m_pGameListener->ObjectWake( pObject );
+				else
+					m_pGameListener->ObjectSleep( pObject );
+			}
+		}
+
+		m_FlushBodies.clear();
+	}
+
+private:
+	const JPH::PhysicsSystem &m_PhysicsSystem;
+
+	IPhysicsObjectEvent *m_pGameListener = nullptr;
+
+	JoltPhysicsEventTracker< JPH::BodyID >	m_ActivationEvents;
+	std::vector< JPH::BodyID >				m_FlushBodies;
+};
@@ -32,6 +32,42 @@ enum VPhysicsGameFlags : uint32
 	FVPHYSICS_NO_SELF_COLLISIONS	= 0x8000,
 };
 
+// Buffers up events from whichever job thread they happen on, so they can be
+// sent to the game all at once after the simulation without any locking.
+template < typename Data >
+struct JoltPhysicsEventTracker
+{
+public:
+	template < typename... T >
+	void EmplaceBack( uint32 uThreadId, T&&... val)
+	{
+		m_Mask |= 1ull << uThreadId;
+		m_Events[ uThreadId ].emplace_back( std::forward< T >( val )... );
+	}
+
+	template < bool bClear, typename FuncType >
+	void ForEach( FuncType func )
+	{
+		for ( uint32 thread = m_Mask; thread; thread &= thread - 1 )
+		{
+			const uint32 i = JPH::CountTrailingZeros( thread );
+			for ( auto &event : m_Events[ i ] )
+				func( event );
+
+			if constexpr ( bClear )
+				m_Events[ i ].clear();
+		}
+
+		if constexpr ( bClear )
+			m_Mask = 0ull;
+	}
+
+private:
+	static constexpr uint32 kMaxThreads = 64;
+	std::atomic< uint64_t >	m_Mask = { 0ull };
+	std::vector< Data >		m_Events[ kMaxThreads ];
+};
+
 class JoltPhysicsContactListener final : public JPH::ContactListener
 {
 public:
@@ -42,7 +78,23 @@ public:
 
 	JPH::ValidateResult OnContactValidate( const JPH::Body &inBody1, const JPH::Body &inBody2, JPH::Vec3Arg inBaseOffset, const JPH::CollideShapeResult &inCollisionResult ) override
 	{
-		return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+		JoltPhysicsObject* pObject1 = reinterpret_cast<JoltPhysicsObject*>( inBody1.GetUserData() );
+		JoltPhysicsObject* pObject2 = reinterpret_cast<JoltPhysicsObject*>( inBody2.GetUserData() );
+
+		// Triggers and fluids always want their contacts for their events.
+		if ( pObject1->IsTrigger() || pObject2->IsTrigger() || pObject1->IsFluid() || pObject2->IsFluid() )
+			return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+
+		if ( ShouldCollideCached( inBody1, inBody2 ) )
+			return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+
+		// The game doesn't want these to collide. Only keep them around, as a sensor,
+		// if something wants StartTouch/EndTouch for them, otherwise don't bother
+		// making manifolds at all.
+		if ( m_pGameListener && ShouldTouchCallback( pObject1, pObject2 ) )
+			return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+
+		return JPH::ValidateResult::RejectAllContactsForThisBodyPair;
 	}
 
 	void OnContactAdded( const JPH::Body &inBody1, const JPH::Body &inBody2, const JPH::ContactManifold &inManifold, JPH::ContactSettings &ioSettings ) override
@@ -50,16 +102,23 @@ public:
 		JoltPhysicsObject* pObject1 = reinterpret_cast<JoltPhysicsObject*>( inBody1.GetUserData() );
 		JoltPhysicsObject* pObject2 = reinterpret_cast<JoltPhysicsObject*>( inBody2.GetUserData() );
 
-		bool bShouldCollide = ShouldCollide( pObject1, pObject2 );
+		bool bShouldCollide = ShouldCollideCached( inBody1, inBody2 );
 		// If the game says we shouldn't collide, we will treat this as a sensor
 		// to satisfy the StartTouch/EndTouch events.
 		ioSettings.mIsSensor = !bShouldCollide || ioSettings.mIsSensor;
 
+		// Count every contact, whether we send anything for it or not, so they
+		// always balance out with the removals.
+		const bool bSendStartTouch = AddBodyPairContact( inBody1.GetID(), inBody2.GetID(), m_pGameListener && ShouldSendTouchEvents( pObject1, pObject2 ) );
+
 		if ( !m_pGameListener )
 			return;
 
 		if ( pObject1->IsFluid() || pObject2->IsFluid() )
 		{
+			if ( !bSendStartTouch )
+				return;
+
 			const uint32 uThreadId = GetThreadId();
 
 			if ( pObject1->IsFluid() && ( pObject2->GetCallbackFlags() & CALLBACK_FLUID_TOUCH ) )
@@ -73,6 +132,9 @@ public:
 
 		if ( pObject1->IsTrigger() || pObject2->IsTrigger() )
 		{
+			if ( !bSendStartTouch )
+				return;
+
 			const uint32 uThreadId = GetThreadId();
 
 			if ( pObject1->IsTrigger() )
@@ -117,7 +179,7 @@ public:
 			}
 		}
 
-		if ( ShouldTouchCallback( pObject1, pObject2 ) )
+		if ( bSendStartTouch )
 			m_StartTouchEvents.EmplaceBack( GetThreadId(), JoltPhysicsCollisionInfo( pObject1, pObject2, inManifold ) );
 	}
 
@@ -126,7 +188,7 @@ public:
 		JoltPhysicsObject* pObject1 = reinterpret_cast<JoltPhysicsObject*>( inBody1.GetUserData() );
 		JoltPhysicsObject* pObject2 = reinterpret_cast<JoltPhysicsObject*>( inBody2.GetUserData() );
 
-		bool bShouldCollide = ShouldCollide( pObject1, pObject2 );
+		bool bShouldCollide = ShouldCollideCached( inBody1, inBody2 );
 		// If the game says we shouldn't collide, we will treat this as a sensor
 		// to satisfy the StartTouch/EndTouch events.
 		ioSettings.mIsSensor = !bShouldCollide || ioSettings.mIsSensor;
@@ -150,6 +212,12 @@ public:
 
 	void OnContactRemoved( const JPH::SubShapeIDPair &inSubShapePair )
 	{
+		// This gets called for every sub-shape pair, so only bother with the bodies
+		// once the last contact between them has gone away, and only if we told
+		// the game they started touching.
+		if ( !RemoveBodyPairContact( inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID() ) )
+			return;
+
 		if ( !m_pGameListener )
 			return;
 
@@ -193,9 +261,6 @@ public:
 			return;
 		}
 
-		if ( !ShouldTouchCallback( pObject1, pObject2 ) )
-			return;
-
 		const uint32 uThreadId = GetThreadId();
 
 		// Josh:
@@ -237,6 +302,117 @@ public:
 		return m_pGameSolver->ShouldCollide( pObject0, pObject1, pObject0->GetGameData(), pObject1->GetGameData() );
 	}
 
+	// Jolt validates every hit between two bodies and then adds or persists their manifolds
+	// straight after on the same thread, so remember the last answer for each thread to
+	// avoid asking the game over and over for the same pair in the same step.
+	bool ShouldCollideCached( const JPH::Body &inBody1, const JPH::Body &inBody2 )
+	{
+		struct ShouldCollideCache_t
+		{
+			const JoltPhysicsContactListener	*pListener = nullptr;
+			uint32								uStep = 0;
+			JPH::BodyID							bodyID1;
+			JPH::BodyID							bodyID2;
+			bool								bShouldCollide = false;
+		};
+		static thread_local ShouldCollideCache_t s_Cache;
+
+		const uint32 uStep = m_uStep.load( std::memory_order_relaxed );
+		if ( s_Cache.pListener == this && s_Cache.uStep == uStep && s_Cache.bodyID1 == inBody1.GetID() && s_Cache.bodyID2 == inBody2.GetID() )
+			return s_Cache.bShouldCollide;
+
+		JoltPhysicsObject* pObject1 = reinterpret_cast<JoltPhysicsObject*>( inBody1.GetUserData() );
+		JoltPhysicsObject* pObject2 = reinterpret_cast<JoltPhysicsObject*>( inBody2.GetUserData() );
+
+		s_Cache.pListener = this;
+		s_Cache.uStep = uStep;
+		s_Cache.bodyID1 = inBody1.GetID();
+		s_Cache.bodyID2 = inBody2.GetID();
+		s_Cache.bShouldCollide = ShouldCollide( pObject1, pObject2 );
+		return s_Cache.bShouldCollide;
+	}
+
+	// Jolt gives us contacts per sub-shape pair, but the game only wants to
+	// hear about touching per object pair. Count every contact between each pair
+	// of bodies, and remember if we sent a start event for them, so we can send
+	// the matching end event when the last one goes away.
+	static uint64 GetBodyPairKey( JPH::BodyID bodyID1, JPH::BodyID bodyID2 )
+	{
+		uint32 uID1 = bodyID1.GetIndexAndSequenceNumber();
+		uint32 uID2 = bodyID2.GetIndexAndSequenceNumber();
+		if ( uID1 > uID2 )
+			std::swap( uID1, uID2 );
+
+		return ( uint64( uID1 ) << 32 ) | uint64( uID2 );
+	}
+
+	struct BodyPairContacts_t
+	{
+		uint32	uContacts = 0;
+		bool	bStartTouchSent = false;
+	};
+
+	struct BodyPairContactsShard_t
+	{
+		std::mutex											lock;
+		std::unordered_map< uint64, BodyPairContacts_t >	contacts;
+	};
+
+	BodyPairContactsShard_t &GetBodyPairContactsShard( uint64 uKey )
+	{
+		// Fibonacci hash, so pairs with the same body still end up spread out.
+		return m_BodyPairContacts[ ( uKey * 0x9E3779B97F4A7C15ull ) >> ( 64 - kBodyPairContactsShardBits ) ];
+	}
+
+	// Returns true if the game should be sent a start event for these bodies now,
+	// ie. they want one and haven't been sent one yet.
+	bool AddBodyPairContact( JPH::BodyID bodyID1, JPH::BodyID bodyID2, bool bWantsStartTouch )
+	{
+		const uint64 uKey = GetBodyPairKey( bodyID1, bodyID2 );
+		BodyPairContactsShard_t &shard = GetBodyPairContactsShard( uKey );
+		std::unique_lock lock( shard.lock );
+
+		BodyPairContacts_t &pair = shard.contacts[ uKey ];
+		pair.uContacts++;
+		if ( !bWantsStartTouch || pair.bStartTouchSent )
+			return false;
+
+		pair.bStartTouchSent = true;
+		return true;
+	}
+
+	// Returns true if this was the last contact between these bodies and
+	// we sent them a start event.
+	bool RemoveBodyPairContact( JPH::BodyID bodyID1, JPH::BodyID bodyID2 )
+	{
+		const uint64 uKey = GetBodyPairKey( bodyID1, bodyID2 );
+		BodyPairContactsShard_t &shard = GetBodyPairContactsShard( uKey );
+		std::unique_lock lock( shard.lock );
+
+		auto iter = shard.contacts.find( uKey );
+		if ( iter == shard.contacts.end() )
+			return false;
+
+		if ( --iter->second.uContacts != 0 )
+			return false;
+
+		const bool bStartTouchSent = iter->second.bStartTouchSent;
+		shard.contacts.erase( iter );
+		return bStartTouchSent;
+	}
+
+	// Whether the game wants to hear about these starting and stopping touching at all.
+	bool ShouldSendTouchEvents( JoltPhysicsObject *pObject1, JoltPhysicsObject *pObject2 )
+	{
+		if ( pObject1->IsFluid() || pObject2->IsFluid() )
+			return true;
+
+		if ( pObject1->IsTrigger() || pObject2->IsTrigger() )
+			return true;
+
+		return ShouldTouchCallback( pObject1, pObject2 );
+	}
+
 	bool PreEmptGameShouldCollide( JoltPhysicsObject *pObject0, JoltPhysicsObject *pObject1 )
 	{
 		// This function pre-empts the result of the
@@ -312,6 +488,10 @@ public:
 
 	void FlushCallbacks()
 	{
+		// The game can change what collides with what from inside of these callbacks
+		// or before the next step, so forget any cached ShouldCollide results.
+		m_uStep++;
+
 		if ( !m_pGameListener )
 			return;
 
@@ -384,8 +564,6 @@ public:
 			m_pGameListener->PostSimulationFrame();
 	}
 
-private:
-
 	static uint32 GetThreadId()
 	{
 		static thread_local uint32 s_ThreadId = ~0u;
@@ -395,6 +573,8 @@ private:
 		return s_ThreadId;
 	}
 
+private:
+
 	const JPH::PhysicsSystem &m_PhysicsSystem;
 
 	IPhysicsCollisionEvent	*m_pGameListener = nullptr;
@@ -402,6 +582,14 @@ private:
 
 	std::mutex m_ShouldCollideLock;
 
+	// Bumped every step to throw away ShouldCollideCached's results.
+	std::atomic< uint32 > m_uStep = { 0u };
+
+	// Contacts between each pair of bodies, split up by pair so that contacts
+	// coming and going on different threads don't all wait on the one lock.
+	static constexpr uint32 kBodyPairContactsShardBits = 5;
+	BodyPairContactsShard_t m_BodyPairContacts[ 1u << kBodyPairContactsShardBits ];
+
 	class JoltPhysicsCollisionInfo
 	{
 	public:
@@ -536,40 +724,6 @@ private:
 		JoltPhysicsCollisionData	m_Data;
 	};
 
-	template < typename Data >
-	struct JoltPhysicsEventTracker
-	{
-	public:
-		template < typename... T >
-		void EmplaceBack( uint32 uThreadId, T&&... val)
-		{
-			m_Mask |= 1ull << uThreadId;
-			m_Events[ uThreadId ].emplace_back( std::forward< T >( val )... );
-		}
-
-		template < bool bClear, typename FuncType >
-		void ForEach( FuncType func )
-		{
-			for ( uint32 thread = m_Mask; thread; thread &= thread - 1 )
-			{
-				const uint32 i = JPH::CountTrailingZeros( thread );
-				for ( auto &event : m_Events[ i ] )
-					func( event );
-
-				if constexpr ( bClear )
-					m_Events[ i ].clear();
-			}
-
-			if constexpr ( bClear )
-				m_Mask = 0ull;
-		}
-
-	private:
-		static constexpr uint32 kMaxThreads = 64;
-		std::atomic< uint64_t >	m_Mask = { 0ull };
-		std::vector< Data >		m_Events[ kMaxThreads ];
-	};
-
 	// The maximum number of sent collision events to send per-frame.
 	// This is used to play stuff like sounds and physics fx.
 	// This is quite expensive to do so, we rate-limit this quite aggressively.
@@ -13,6 +13,7 @@
 #include "vjolt_environment.h"
 #include "vjolt_layers.h"
 #include "vjolt_controller_shadow.h"
+#include "vjolt_constraints.h"
 
 #include "vjolt_object.h"
 
@@ -63,6 +64,11 @@ JoltPhysicsObject::~JoltPhysicsObject()
 {
 	RemoveShadowController();
 
+	// Each constraint takes itself off of the end of our list as it is torn down,
+	// so this never has to search for anything, even with hundreds of them.
+	while ( m_pConstraints.Count() )
+		m_pConstraints.Tail()->OnJoltPhysicsObjectDestroyed( this );
+
 	// Josh:
 	// Iterate over this in reverse as we could remove a listener from inside this callback
 	for ( int i = m_destroyedListeners.Count() - 1; i >= 0; i-- )
@@ -70,6 +76,15 @@ JoltPhysicsObject::~JoltPhysicsObject()
 
 	m_pEnvironment->RemoveDirtyStaticBody( GetBodyID() );
 
+	if ( m_bHinged )
+		m_pPhysicsSystem->RemoveConstraint( m_pWorldHinge );
+
+	if ( m_bUseAlternateGravity )
+		m_pEnvironment->RemoveAlternateGravityObject( this );
+
+	// The body may be the last thing holding on to the collide the game gave us.
+	ReleaseCollideInfo( m_pBody->GetShape() );
+
 	JPH::BodyInterface& bodyInterface = m_pPhysicsSystem->GetBodyInterfaceNoLock();
 	bodyInterface.DestroyBody( GetBodyID() );
 }
@@ -98,8 +113,7 @@ bool JoltPhysicsObject::IsFluid() const
 
 bool JoltPhysicsObject::IsHinged() const
 {
-	Log_Stub( LOG_VJolt );
-	return false;
+	return m_bHinged;
 }
 
 bool JoltPhysicsObject::IsCollisionEnabled() const
@@ -109,13 +123,8 @@ bool JoltPhysicsObject::IsCollisionEnabled() const
 
 bool JoltPhysicsObject::IsGravityEnabled() const
 {
-	if ( !m_pBody->IsStatic() )
-	{
-		JPH::MotionProperties* pMotionProperties = m_pBody->GetMotionProperties();
-		return pMotionProperties->GetGravityFactor() != 0.0f;
-	}
-
-	return false;
+	// Can't go by the gravity factor, alternate gravity can make it zero.
+	return !m_pBody->IsStatic() && m_bGravityEnabled;
 }
 
 bool JoltPhysicsObject::IsDragEnabled() const
@@ -136,7 +145,21 @@ bool JoltPhysicsObject::IsMoveable() const
 
 bool JoltPhysicsObject::IsAttachedToConstraint( bool bExternalOnly ) const
 {
-	Log_Stub( LOG_VJolt );
+	if ( !bExternalOnly )
+		return m_bHinged || m_pConstraints.Count() != 0;
+
+	// Like IVP, a constraint is external if the object on the other end
+	// belongs to something else, ie. not another bone of our ragdoll.
+	for ( JoltPhysicsConstraint *pConstraint : m_pConstraints )
+	{
+		IPhysicsObject *pOther = pConstraint->GetReferenceObject() == this
+			? pConstraint->GetAttachedObject()
+			: pConstraint->GetReferenceObject();
+
+		if ( pOther && pOther->GetGameData() != m_pGameData )
+			return true;
+	}
+
 	return false;
 }
 
@@ -152,11 +175,8 @@ void JoltPhysicsObject::EnableCollisions( bool enable )
 
 void JoltPhysicsObject::EnableGravity( bool enable )
 {
-	if ( !m_pBody->IsStatic() )
-	{
-		JPH::MotionProperties* pMotionProperties = m_pBody->GetMotionProperties();
-		pMotionProperties->SetGravityFactor( enable ? 1.0f : 0.0f );
-	}
+	m_bGravityEnabled = enable;
+	UpdateGravity();
 }
 
 void JoltPhysicsObject::EnableDrag( bool enable )
@@ -544,12 +564,12 @@ void JoltPhysicsObject::GetVelocityAtPoint( const Vector &worldPosition, Vector
 
 void JoltPhysicsObject::GetImplicitVelocity( Vector *velocity, AngularImpulse *angularVelocity ) const
 {
-	Log_Stub( LOG_VJolt );
-	if ( velocity )
-		*velocity = vec3_origin;
-
-	if ( angularVelocity )
-		*angularVelocity = vec3_origin;
+	// In IVP this is the velocity the object will have once its pending speed changes
+	// go through. Jolt applies impulses to the velocity straight away, and MoveKinematic
+	// stores the velocity it takes to get from the last step's transform to the
+	// kinematic target on the body, where it stays between steps.
+	// So shadows and kinematic movers already have their implied velocity on the body.
+	GetVelocity( velocity, angularVelocity );
 }
 
 void JoltPhysicsObject::LocalToWorld( Vector *worldPosition, const Vector &localPosition ) const
@@ -990,12 +1010,53 @@ void JoltPhysicsObject::RemoveTrigger()
 
 void JoltPhysicsObject::BecomeHinged( int localAxis )
 {
-	Log_Stub( LOG_VJolt );
+	if ( IsStatic() || localAxis < 0 || localAxis > 2 )
+		return;
+
+	RemoveHinged();
+
+	const JPH::Vec3 pivot = m_pBody->GetCenterOfMassPosition();
+	Vector localHingeAxis = vec3_origin;
+	localHingeAxis[ localAxis ] = 1.0f;
+	const JPH::Vec3 worldHingeAxis = m_pBody->GetRotation() * SourceToJolt::Unitless( localHingeAxis );
+
+	// Jolt constraints are tied to their bodies when created, so the
+	// one we made last time can only be re-used if we are hinging about
+	// the same place in the world again. Doors toggling this on and off
+	// in place is the common case, and that then costs nothing.
+	bool bReuse = false;
+	if ( m_pWorldHinge != nullptr && m_nWorldHingeAxis == localAxis )
+	{
+		const JPH::Mat44 hingeFrame = m_pWorldHinge->GetConstraintToBody1Matrix();
+		bReuse = hingeFrame.GetTranslation().IsClose( pivot, 1e-6f ) && hingeFrame.GetAxisX().Dot( worldHingeAxis ) > 0.9999f;
+	}
+
+	if ( !bReuse )
+	{
+		JPH::HingeConstraintSettings settings;
+		settings.mPoint1 = settings.mPoint2 = pivot;
+		settings.mHingeAxis1 = settings.mHingeAxis2 = worldHingeAxis;
+		settings.mNormalAxis1 = settings.mNormalAxis2 = worldHingeAxis.GetNormalizedPerpendicular();
+
+		m_pWorldHinge = static_cast< JPH::HingeConstraint * >( settings.Create( JPH::Body::sFixedToWorld, *m_pBody ) );
+		m_nWorldHingeAxis = localAxis;
+	}
+
+	m_pPhysicsSystem->AddConstraint( m_pWorldHinge );
+	m_bHinged = true;
+
+	Wake();
 }
 
 void JoltPhysicsObject::RemoveHinged()
 {
-	Log_Stub( LOG_VJolt );
+	if ( !m_bHinged )
+		return;
+
+	m_pPhysicsSystem->RemoveConstraint( m_pWorldHinge );
+	m_bHinged = false;
+
+	Wake();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1021,7 +1082,16 @@ void JoltPhysicsObject::OutputDebugInfo() const
 
 void JoltPhysicsObject::SetUseAlternateGravity( bool bSet )
 {
-	Log_Stub( LOG_VJolt );
+	if ( m_bUseAlternateGravity == bSet )
+		return;
+
+	m_bUseAlternateGravity = bSet;
+	if ( bSet )
+		m_pEnvironment->AddAlternateGravityObject( this );
+	else
+		m_pEnvironment->RemoveAlternateGravityObject( this );
+
+	UpdateGravity();
 }
 
 void JoltPhysicsObject::SetCollisionHints( uint32 collisionHints )
@@ -1062,8 +1132,22 @@ void JoltPhysicsObject::SyncWith( IPhysicsObject *pOther )
 
 void JoltPhysicsObject::UpdateEnvironment( JoltPhysicsEnvironment *pEnvironment )
 {
+	if ( m_bHinged )
+		m_pPhysicsSystem->RemoveConstraint( m_pWorldHinge );
+
+	if ( m_bUseAlternateGravity )
+		m_pEnvironment->RemoveAlternateGravityObject( this );
+
 	m_pEnvironment = pEnvironment;
 	m_pPhysicsSystem = pEnvironment->GetPhysicsSystem();
+
+	if ( m_bHinged )
+		m_pPhysicsSystem->AddConstraint( m_pWorldHinge );
+
+	if ( m_bUseAlternateGravity )
+		m_pEnvironment->AddAlternateGravityObject( this );
+
+	UpdateGravity();
 }
 
 void JoltPhysicsObject::AddDestroyedListener( IJoltObjectDestroyedListener *pListener )
@@ -1076,6 +1160,24 @@ void JoltPhysicsObject::RemoveDestroyedListener( IJoltObjectDestroyedListener *p
 	m_destroyedListeners.FindAndRemove( pListener );
 }
 
+void JoltPhysicsObject::AddConstraint( JoltPhysicsConstraint *pConstraint )
+{
+	m_pConstraints.AddToTail( pConstraint );
+}
+
+void JoltPhysicsObject::RemoveConstraint( JoltPhysicsConstraint *pConstraint )
+{
+	// Search from the end, that's where our destructor removes them from.
+	for ( int i = m_pConstraints.Count() - 1; i >= 0; i-- )
+	{
+		if ( m_pConstraints[ i ] == pConstraint )
+		{
+			m_pConstraints.FastRemove( i );
+			return;
+		}
+	}
+}
+
 void JoltPhysicsObject::AddToPosition( JPH::Vec3Arg addPos )
 {
 	const JPH::BodyLockInterfaceNoLock &bodyLockInterface = m_pPhysicsSystem->GetBodyLockInterfaceNoLock();
@@ -1125,6 +1227,18 @@ void JoltPhysicsObject::CalculateBuoyancy()
 	}
 }
 
+void JoltPhysicsObject::UpdateGravity()
+{
+	if ( m_pBody->IsStatic() )
+		return;
+
+	float flGravityFactor = 0.0f;
+	if ( m_bGravityEnabled )
+		flGravityFactor = m_bUseAlternateGravity ? m_pEnvironment->GetAlternateGravityFactor() : 1.0f;
+
+	m_pBody->GetMotionProperties()->SetGravityFactor( flGravityFactor );
+}
+
 float JoltPhysicsObject::GetMaterialDensity() const
 {
 	return m_flMaterialDensity;
@@ -1166,6 +1280,10 @@ void JoltPhysicsObject::SaveObjectState( JPH::StateRecorder &recorder )
 	recorder.Write( m_flBuoyancyRatio );
 	recorder.Write( m_flVolume );
 	recorder.Write( m_GameMaterial );
+	recorder.Write( m_bHinged );
+	recorder.Write( m_nWorldHingeAxis );
+	recorder.Write( m_bGravityEnabled );
+	recorder.Write( m_bUseAlternateGravity );
 
 	// Josh:
 	// In regular VPhysics, shadows are serialized but then forced to never be read.
@@ -1197,9 +1315,23 @@ void JoltPhysicsObject::RestoreObjectState( JPH::StateRecorder &recorder )
 	recorder.Read( m_flVolume );
 	recorder.Read( m_GameMaterial );
 
+	bool bHinged;
+	int nHingeAxis;
+	recorder.Read( bHinged );
+	recorder.Read( nHingeAxis );
+	recorder.Read( m_bGravityEnabled );
+	recorder.Read( m_bUseAlternateGravity );
+
+	if ( m_bUseAlternateGravity )
+		m_pEnvironment->AddAlternateGravityObject( this );
+
 	// Recompute states.
 	UpdateMaterialProperties();
 	UpdateLayer();
+	UpdateGravity();
+
+	if ( bHinged )
+		BecomeHinged( nHingeAxis );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1241,6 +1373,12 @@ void JoltPhysicsObject::UpdateLayer()
 			m_pEnvironment->RemoveDirtyStaticBody( m_pBody->GetID() );
 
 		bodyInterface.SetMotionType( m_pBody->GetID(), bStaticMotionType ? JPH::EMotionType::Static : JPH::EMotionType::Dynamic, JPH::EActivation::Activate );
+
+		// Debris only ever hits the world and nobody notices if a gib
+		// clips a little, so don't pay for the linear cast sweeps on it.
+		// Jolt still reduces its manifolds like everything else.
+		const bool bLinearCast = m_pEnvironment->IsUsingLinearCast() && !bDebris;
+		bodyInterface.SetMotionQuality( m_pBody->GetID(), bLinearCast ? JPH::EMotionQuality::LinearCast : JPH::EMotionQuality::Discrete );
 	}
 
 	// Update layer
@@ -9,6 +9,7 @@
 class IPredictedPhysicsObject;
 
 class IJoltObjectDestroyedListener;
+class JoltPhysicsConstraint;
 class JoltPhysicsShadowController;
 class JoltPhysicsFluidController;
 class JoltPhysicsEnvironment;
@@ -165,6 +166,11 @@ public:
 	void AddDestroyedListener( IJoltObjectDestroyedListener *pListener );
 	void RemoveDestroyedListener( IJoltObjectDestroyedListener *pListener );
 
+	// Constraints attached to this object, these get torn down directly when we are
+	// destroyed rather than going through the destroyed listeners.
+	void AddConstraint( JoltPhysicsConstraint *pConstraint );
+	void RemoveConstraint( JoltPhysicsConstraint *pConstraint );
+
 	// Grabs the position, adds addPos and teleports the object
 	void AddToPosition( JPH::Vec3Arg addPos );
 
@@ -178,6 +184,10 @@ public:
 
 	void CalculateBuoyancy();
 
+	// Sets the gravity factor from whether gravity is enabled and
+	// whether we are using the environment's alternate gravity.
+	void UpdateGravity();
+
 	float GetMaterialDensity() const;
 	float GetBuoyancyRatio() const;
 	float GetVolume() const { return m_flVolume; }
@@ -210,6 +220,10 @@ public:
 		m_pFluidController = pFluidController;
 	}
 
+	// Whether the game's object event handler was last told we woke up or went to sleep.
+	bool WasReportedAwake() const { return m_bReportedAwake; }
+	void SetReportedAwake( bool bAwake ) { m_bReportedAwake = bAwake; }
+
 	// Fakes a linear velocity so we can have correct before/after velocity
 	// when going between PreCollision and PostCollision callbacks.
 	JPH::Vec3 FakeJoltLinearVelocity( JPH::Vec3Arg fakeVelocity )
@@ -247,6 +261,8 @@ private:
 
 	bool m_bStatic = false;
 	bool m_bPinned = false;
+	bool m_bGravityEnabled = true;
+	bool m_bUseAlternateGravity = false;
 
 	int m_materialIndex = 0;
 	uint m_contents = CONTENTS_SOLID;
@@ -263,8 +279,16 @@ private:
 
 	unsigned short m_GameMaterial = 0;
 
+	// World hinge from BecomeHinged. This is kept around after RemoveHinged
+	// so that hinging again in the same place doesn't have to allocate.
+	JPH::Ref< JPH::HingeConstraint > m_pWorldHinge;
+	int m_nWorldHingeAxis = -1;
+	bool m_bHinged = false;
+
+	bool m_bReportedAwake = false;
 
 	CUtlVector< IJoltObjectDestroyedListener * > m_destroyedListeners;
+	CUtlVectorFixedGrowable< JoltPhysicsConstraint *, 4 > m_pConstraints;
 
 	// Shadow variables
 	JoltPhysicsShadowController *m_pShadowController = nullptr;
@@ -283,3 +307,14 @@ inline float GetInvEffectiveMass( JoltPhysicsObject *pObject0, JoltPhysicsObject
 	return ( pObject0->IsStatic() ? 0.0f : pObject0->GetInvMass() ) + ( pObject1->IsStatic() ? 0.0f : pObject1->GetInvMass() );
 }
 
+
+// Vehicle wheels are handed to the game as IPhysicsObjects too, but they have no body
+// behind them. Use this on any IPhysicsObject the game gives us before treating it as
+// a JoltPhysicsObject, it returns nullptr for wheels.
+inline JoltPhysicsObject *ToJoltPhysicsObject( IPhysicsObject *pObject )
+{
+	if ( !pObject || ( pObject->GetCallbackFlags() & CALLBACK_IS_VEHICLE_WHEEL ) )
+		return nullptr;
+
+	return static_cast< JoltPhysicsObject * >( pObject );
+}
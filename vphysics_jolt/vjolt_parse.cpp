@@ -11,10 +11,72 @@
 
 //-------------------------------------------------------------------------------------------------
 
+// What a block was last parsed as, so the result can be replayed.
+enum class JoltKeyBlockType
+{
+	None,
+	Solid,
+	Fluid,
+	RagdollConstraint,
+	Vehicle,
+	RagdollAnimatedFriction,
+};
+
+struct JoltKeyBlockResult
+{
+	JoltKeyBlockType	Type = JoltKeyBlockType::None;
+
+	// The object as it was before parsing (after SetDefaults) and after.
+	std::vector< byte >	Defaults;
+	std::vector< byte >	Result;
+
+	// The parse only depends on the text and the bytes in Reads (array counts),
+	// so the result gets replayed if those match, by copying over just the bytes in Writes.
+	// Everything else the game set up is left alone.
+	std::vector< JoltKVSchemaWriteRecorder::Range > Reads;
+	std::vector< JoltKVSchemaWriteRecorder::Range > Writes;
+
+	std::vector< std::pair< std::string, std::string > > UnknownKeys;
+
+	bool Wrote( size_t nOffset ) const
+	{
+		for ( const auto &[ nWriteOffset, nSize ] : Writes )
+		{
+			if ( nOffset >= nWriteOffset && nOffset < nWriteOffset + nSize )
+				return true;
+		}
+		return false;
+	}
+};
+
+struct JoltKeyBlock
+{
+	std::string			Name;
+	size_t				nOffset = 0;	// Start of the block in the parsed text
+
+	std::shared_ptr< const JoltKeyBlockResult > pResult;
+};
+
+// Everything we learnt from one buffer of key data.
+struct JoltKeyParseCacheEntry
+{
+	uint64				nHash = 0;
+	std::string			KeyData;
+
+	// Either KeyData, or the dummy blocks if that failed to parse.
+	const char			*pszText = nullptr;
+
+	std::vector< JoltKeyBlock > Blocks;
+};
+
+//-------------------------------------------------------------------------------------------------
+
 class JoltPhysicsParseKV final : public IVPhysicsKeyParser
 {
 public:
-	JoltPhysicsParseKV( KeyValues *pKV );
+	// bShared is false for parsers that must leave the global cache and its counters alone,
+	// like the benchmark's.
+	JoltPhysicsParseKV( std::shared_ptr< JoltKeyParseCacheEntry > pEntry, bool bCached, bool bShared = true );
 	~JoltPhysicsParseKV() override;
 
 	const char* GetCurrentBlockName() override;
@@ -33,8 +95,28 @@ private:
 
 	void		NextBlock();
 
-	KeyValues *m_pKV;
-	KeyValues *m_pCurrentBlock;
+	// Gets the reader onto the current block if it isn't already.
+	JoltKVProp *GetBlockProp();
+
+	// Parses the current block with the given schema, or replays the last
+	// parse of it from the cache.
+	// Pointers in the object are never recorded or replayed, pass their offsets in
+	// pointerOffsets and set them up again from the result afterwards.
+	std::shared_ptr< const JoltKeyBlockResult > ParseSchemaBlock( JoltKeyBlockType type, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, size_t size, IVPhysicsKeyHandler *unknownKeyHandler, std::initializer_list< size_t > pointerOffsets = {} );
+
+	std::shared_ptr< JoltKeyParseCacheEntry > m_pEntry;
+
+	// True while we are still discovering the blocks of the entry,
+	// false once it came from the cache or we hit the end.
+	bool		m_bIndexing = false;
+	bool		m_bShared = true;
+
+	JoltKVReader m_Reader;
+
+	int			m_nBlock = -1;
+	JoltKVProp	m_CurrentBlock;
+	bool		m_bReaderAtBlock = false;
+	bool		m_bHasBlock = false;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -151,7 +233,7 @@ static const JoltKVSchemaProp_t kVehicleAxleDescs[] =
 	{ "Wheel",			KVSCHEMA_DESC( vehicle_axleparams_t, wheels ),
 		{
 			sizeof( vehicle_wheelparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_wheelparams_t *pWheelParams = reinterpret_cast< vehicle_wheelparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleAxleWheelDescs, ARRAYSIZE( kVehicleAxleWheelDescs ), pWheelParams );
@@ -161,7 +243,7 @@ static const JoltKVSchemaProp_t kVehicleAxleDescs[] =
 	{ "Suspension",		KVSCHEMA_DESC( vehicle_axleparams_t, suspension ),
 		{
 			sizeof( vehicle_suspensionparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_suspensionparams_t *pSuspensionParams = reinterpret_cast< vehicle_suspensionparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleAxleSuspensionDescs, ARRAYSIZE( kVehicleAxleSuspensionDescs ), pSuspensionParams );
@@ -200,7 +282,7 @@ static const JoltKVSchemaProp_t kVehicleEngineDescs[] =
 	{ "Boost",					KVSCHEMA_DESC_NO_OFFSET( vehicle_engineparams_t ),
 		{
 			sizeof( vehicle_engineparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_engineparams_t *pEngineParams = reinterpret_cast< vehicle_engineparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleEngineBoostDescs, ARRAYSIZE( kVehicleEngineBoostDescs ), pEngineParams );
@@ -256,7 +338,7 @@ static const JoltKVSchemaProp_t kVehicleDescs[] =
 	{ "Axle",			KVSCHEMA_DESC_ARRAY( vehicleparams_t, axles, axleCount ),
 		{
 			sizeof( vehicle_axleparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_axleparams_t *pAxleParams = reinterpret_cast< vehicle_axleparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleAxleDescs, ARRAYSIZE( kVehicleAxleDescs ), pAxleParams );
@@ -266,7 +348,7 @@ static const JoltKVSchemaProp_t kVehicleDescs[] =
 	{ "Body",			KVSCHEMA_DESC( vehicleparams_t, body ),
 		{
 			sizeof( vehicle_bodyparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_bodyparams_t *pBodyParams = reinterpret_cast< vehicle_bodyparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleBodyDescs, ARRAYSIZE( kVehicleBodyDescs ), pBodyParams );
@@ -276,7 +358,7 @@ static const JoltKVSchemaProp_t kVehicleDescs[] =
 	{ "Engine",			KVSCHEMA_DESC( vehicleparams_t, engine ),
 		{
 			sizeof( vehicle_engineparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_engineparams_t *pEngineParams = reinterpret_cast< vehicle_engineparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleEngineDescs, ARRAYSIZE( kVehicleEngineDescs ), pEngineParams );
@@ -286,7 +368,7 @@ static const JoltKVSchemaProp_t kVehicleDescs[] =
 	{ "Steering",		KVSCHEMA_DESC( vehicleparams_t, steering ),
 		{
 			sizeof( vehicle_steeringparams_t ),
-			[]( KeyValues *pProp, void *pPtr, size_t size )
+			[]( JoltKVProp *pProp, void *pPtr, size_t size )
 			{
 				vehicle_steeringparams_t *pSteeringParams = reinterpret_cast< vehicle_steeringparams_t * >( pPtr );
 				ParseJoltKVSchema( pProp, kVehicleSteeringDescs, ARRAYSIZE( kVehicleSteeringDescs ), pSteeringParams );
@@ -322,10 +404,64 @@ static const JoltKVSchemaProp_t kRagdollAnimatedFrictionDescs[] =
 
 //-------------------------------------------------------------------------------------------------
 
-JoltPhysicsParseKV::JoltPhysicsParseKV( KeyValues *pKV )
-	: m_pKV( pKV )
-	, m_pCurrentBlock( m_pKV->GetFirstSubKey() )
+static constexpr const char* DummyParserKeyValues = R"(
+"solid"
+{
+	"dummy" "1"
+}
+"vehicle"
+{
+	"dummy" "1"
+}
+"vehicle_sounds"
+{
+	"dummy" "1"
+}
+"vehicle_view"
+{
+	"dummy" "1"
+}
+"ragdollconstraint"
+{
+	"dummy" "1"
+}
+"collisionrules"
+{
+	"dummy" "1"
+}
+)";
+
+//-------------------------------------------------------------------------------------------------
+
+JoltPhysicsParseKV::JoltPhysicsParseKV( std::shared_ptr< JoltKeyParseCacheEntry > pEntry, bool bCached, bool bShared )
+	: m_pEntry( std::move( pEntry ) )
+	, m_bIndexing( !bCached )
+	, m_bShared( bShared )
 {
+	if ( m_bIndexing )
+	{
+		m_pEntry->pszText = m_pEntry->KeyData.c_str();
+		m_Reader.Init( m_pEntry->pszText );
+	}
+
+	NextBlock();
+
+	// Josh: Ideally we would return nullptr here, but that breaks a lot of things.
+	// If we fail to parse the KV, simply just fall-back to a dummy KV that will cause things
+	// to get zero-initialized.
+	// Data that goes bad part of the way through just ends at the last good block.
+	// In the future, we may want to add a KV patching pass to fix up broken model and vehicle data.
+	if ( !bCached && m_Reader.IsFailed() && !m_bHasBlock )
+	{
+		Log_Warning( LOG_VJolt, "CreateVPhysicsKeyParser: Encountered invalid KV data. Falling back to a dummy KV. You may notice a broken prop/vehicle.\n" );
+
+		m_pEntry->pszText = DummyParserKeyValues;
+		m_Reader.Init( m_pEntry->pszText );
+		m_CurrentBlock = JoltKVProp();
+		m_nBlock = -1;
+		m_bIndexing = true;
+		NextBlock();
+	}
 }
 
 JoltPhysicsParseKV::~JoltPhysicsParseKV()
@@ -336,15 +472,15 @@ JoltPhysicsParseKV::~JoltPhysicsParseKV()
 
 const char* JoltPhysicsParseKV::GetCurrentBlockName()
 {
-	if ( !m_pCurrentBlock )
+	if ( !m_bHasBlock )
 		return nullptr;
 
-	return m_pCurrentBlock->GetName();
+	return m_pEntry->Blocks[ m_nBlock ].Name.c_str();
 }
 
 bool		JoltPhysicsParseKV::Finished()
 {
-	return !m_pCurrentBlock;
+	return !m_bHasBlock;
 }
 
 void		JoltPhysicsParseKV::ParseSolid( solid_t *pSolid, IVPhysicsKeyHandler *unknownKeyHandler )
@@ -354,7 +490,12 @@ void		JoltPhysicsParseKV::ParseSolid( solid_t *pSolid, IVPhysicsKeyHandler *unkn
 	else
 		V_memset( pSolid, 0, sizeof( *pSolid ) );
 
-	ParseJoltKVSchema( m_pCurrentBlock, kSolidDescs, ARRAYSIZE( kSolidDescs ), pSolid, pSolid, unknownKeyHandler );
+	std::shared_ptr< const JoltKeyBlockResult > pResult = ParseSchemaBlock( JoltKeyBlockType::Solid, kSolidDescs, ARRAYSIZE( kSolidDescs ), pSolid, sizeof( *pSolid ), unknownKeyHandler,
+		{ offsetof( solid_t, params.massCenterOverride ) } );
+
+	// The override pointer isn't replayed, point it at this solid's Vector if the data had one.
+	if ( pResult->Wrote( offsetof( solid_t, massCenterOverride ) ) )
+		pSolid->params.massCenterOverride = &pSolid->massCenterOverride;
 
 	NextBlock();
 }
@@ -369,7 +510,7 @@ void		JoltPhysicsParseKV::ParseFluid( fluid_t *pFluid, IVPhysicsKeyHandler *unkn
 		V_strncpy( pFluid->surfaceprop, "water", sizeof( pFluid->surfaceprop ) );
 	}
 
-	ParseJoltKVSchema( m_pCurrentBlock, kFluidDescs, ARRAYSIZE( kFluidDescs ), pFluid, pFluid, unknownKeyHandler );
+	ParseSchemaBlock( JoltKeyBlockType::Fluid, kFluidDescs, ARRAYSIZE( kFluidDescs ), pFluid, sizeof( *pFluid ), unknownKeyHandler );
 
 	NextBlock();
 }
@@ -388,17 +529,20 @@ void		JoltPhysicsParseKV::ParseRagdollConstraint( constraint_ragdollparams_t *pC
 	// Josh: The KV specifies clockwise rotations.  
 	pConstraint->useClockwiseRotations = true;
 
-	ParseJoltKVSchema( m_pCurrentBlock, kRagdollDescs, ARRAYSIZE( kRagdollDescs ), pConstraint, pConstraint, unknownKeyHandler );
+	ParseSchemaBlock( JoltKeyBlockType::RagdollConstraint, kRagdollDescs, ARRAYSIZE( kRagdollDescs ), pConstraint, sizeof( *pConstraint ), unknownKeyHandler );
 
 	NextBlock();
 }
 
 void		JoltPhysicsParseKV::ParseSurfaceTable( int *table, IVPhysicsKeyHandler *unknownKeyHandler )
 {
-	for ( KeyValues* pProp = m_pCurrentBlock->GetFirstSubKey(); pProp != nullptr; pProp = pProp->GetNextKey() )
+	JoltKVProp *pBlock = GetBlockProp();
+
+	JoltKVProp prop;
+	while ( pBlock->NextSubKey( &prop ) )
 	{
-		int nPropIdx  = JoltPhysicsSurfaceProps::GetInstance().GetSurfaceIndex( pProp->GetName() );
-		int nTableIdx = pProp->GetInt();
+		int nPropIdx  = JoltPhysicsSurfaceProps::GetInstance().GetSurfaceIndex( prop.GetName() );
+		int nTableIdx = prop.GetInt();
 
 		if ( nTableIdx < 128 )
 			table[nTableIdx] = nPropIdx;
@@ -412,7 +556,7 @@ void		JoltPhysicsParseKV::ParseCustom( void *pCustom, IVPhysicsKeyHandler *unkno
 	if ( unknownKeyHandler )
 		unknownKeyHandler->SetDefaults( pCustom );
 
-	ParseJoltKVCustom( m_pCurrentBlock, pCustom, unknownKeyHandler );
+	ParseJoltKVCustom( GetBlockProp(), pCustom, unknownKeyHandler );
 
 	NextBlock();
 }
@@ -424,7 +568,7 @@ void		JoltPhysicsParseKV::ParseVehicle( vehicleparams_t *pVehicle, IVPhysicsKeyH
 	else
 		V_memset( pVehicle, 0, sizeof( *pVehicle ) );
 
-	ParseJoltKVSchema( m_pCurrentBlock, kVehicleDescs, ARRAYSIZE( kVehicleDescs ), pVehicle, pVehicle, unknownKeyHandler);
+	ParseSchemaBlock( JoltKeyBlockType::Vehicle, kVehicleDescs, ARRAYSIZE( kVehicleDescs ), pVehicle, sizeof( *pVehicle ), unknownKeyHandler );
 
 	NextBlock();
 }
@@ -445,7 +589,8 @@ void		JoltPhysicsParseKV::ParseCollisionRules( ragdollcollisionrules_t *pRules,
 		.pUnknownKeyHandler = unknownKeyHandler,
 	};
 
-	ParseJoltKVSchema( m_pCurrentBlock, kCollisionRulesDescs, ARRAYSIZE( kCollisionRulesDescs ), &helper, pRules, unknownKeyHandler );
+	// Not cached, this talks to the collision set as it goes.
+	ParseJoltKVSchema( GetBlockProp(), kCollisionRulesDescs, ARRAYSIZE( kCollisionRulesDescs ), &helper, pRules, unknownKeyHandler );
 
 	if ( pRules )
 		*pRules = helper.Rules;
@@ -460,50 +605,242 @@ void		JoltPhysicsParseKV::ParseRagdollAnimatedFriction( ragdollanimatedfriction_
 	else
 		V_memset( pFriction, 0, sizeof( *pFriction ) );
 
-	ParseJoltKVSchema( m_pCurrentBlock, kRagdollAnimatedFrictionDescs, ARRAYSIZE( kRagdollAnimatedFrictionDescs ), pFriction, pFriction, unknownKeyHandler );
+	ParseSchemaBlock( JoltKeyBlockType::RagdollAnimatedFriction, kRagdollAnimatedFrictionDescs, ARRAYSIZE( kRagdollAnimatedFrictionDescs ), pFriction, sizeof( *pFriction ), unknownKeyHandler );
 
 	NextBlock();
 }
 
 //-------------------------------------------------------------------------------------------------
 
+static void PublishKeyParseCacheEntry( std::shared_ptr< JoltKeyParseCacheEntry > pEntry );
+
 void		JoltPhysicsParseKV::NextBlock()
 {
-	if ( m_pCurrentBlock )
-		m_pCurrentBlock = m_pCurrentBlock->GetNextKey();
+	m_nBlock++;
+
+	if ( !m_bIndexing )
+	{
+		m_bReaderAtBlock = false;
+		m_bHasBlock = m_nBlock < int( m_pEntry->Blocks.size() );
+		return;
+	}
+
+	// Finish off whatever the last block left unread,
+	// so the cursor is sitting right before the next one.
+	m_CurrentBlock.Skip();
+	const char *pszBlockStart = m_Reader.GetCursor();
+
+	m_bHasBlock = m_Reader.GetRoot()->NextSubKey( &m_CurrentBlock );
+	m_bReaderAtBlock = m_bHasBlock;
+
+	if ( m_bHasBlock )
+	{
+		JoltKeyBlock &block = m_pEntry->Blocks.emplace_back();
+		block.Name		= m_CurrentBlock.GetName();
+		block.nOffset	= size_t( pszBlockStart - m_pEntry->pszText );
+		return;
+	}
+
+	// That was the last block, everything else can come from the cache now.
+	// Don't keep an empty entry for data that's about to fall back to the dummy.
+	m_bIndexing = false;
+	if ( m_bShared && ( !m_Reader.IsFailed() || !m_pEntry->Blocks.empty() ) )
+		PublishKeyParseCacheEntry( m_pEntry );
+}
+
+JoltKVProp *JoltPhysicsParseKV::GetBlockProp()
+{
+	if ( !m_bReaderAtBlock )
+	{
+		m_Reader.Init( m_pEntry->pszText + m_pEntry->Blocks[ m_nBlock ].nOffset );
+		m_Reader.GetRoot()->NextSubKey( &m_CurrentBlock );
+		m_bReaderAtBlock = true;
+	}
+
+	return &m_CurrentBlock;
 }
 
 //-------------------------------------------------------------------------------------------------
 
-static constexpr const char* DummyParserKeyValues = R"(
-"PhysProps_Fallback"
+// Holds on to unknown keys so they can be handed out again when replaying.
+class JoltRecordingKeyHandler final : public IVPhysicsKeyHandler
 {
-	"solid"
+public:
+	void ParseKeyValue( void *pData, const char *pKey, const char *pValue ) override
 	{
-		"dummy" "1"
+		Keys.emplace_back( pKey, pValue );
 	}
-	"vehicle"
+
+	void SetDefaults( void *pData ) override
 	{
-		"dummy" "1"
 	}
-	"vehicle_sounds"
+
+	std::vector< std::pair< std::string, std::string > > Keys;
+};
+
+static std::mutex s_KeyParseCacheLock;
+static uint s_nKeyParseBlockReplays = 0;
+
+std::shared_ptr< const JoltKeyBlockResult > JoltPhysicsParseKV::ParseSchemaBlock( JoltKeyBlockType type, const JoltKVSchemaProp_t *pDescs, uint count, void *pObj, size_t size, IVPhysicsKeyHandler *unknownKeyHandler, std::initializer_list< size_t > pointerOffsets )
+{
+	JoltKeyBlock &block = m_pEntry->Blocks[ m_nBlock ];
+	const byte *pObjBytes = reinterpret_cast< const byte * >( pObj );
+
+	std::shared_ptr< const JoltKeyBlockResult > pResult;
+	{
+		std::unique_lock lock( s_KeyParseCacheLock );
+		pResult = block.pResult;
+	}
+
+	bool bReplay = pResult && pResult->Type == type && pResult->Defaults.size() == size;
+	if ( bReplay )
 	{
-		"dummy" "1"
+		for ( const auto &[ nOffset, nSize ] : pResult->Reads )
+		{
+			if ( V_memcmp( pResult->Defaults.data() + nOffset, pObjBytes + nOffset, nSize ) != 0 )
+			{
+				bReplay = false;
+				break;
+			}
+		}
 	}
-	"vehicle_view"
+
+	if ( bReplay )
 	{
-		"dummy" "1"
+		for ( const auto &[ nOffset, nSize ] : pResult->Writes )
+			V_memcpy( reinterpret_cast< byte * >( pObj ) + nOffset, pResult->Result.data() + nOffset, nSize );
+
+		if ( m_bShared )
+		{
+			std::unique_lock lock( s_KeyParseCacheLock );
+			s_nKeyParseBlockReplays++;
+		}
 	}
-	"ragdollconstraint"
+	else
 	{
-		"dummy" "1"
+		auto pNewResult = std::make_shared< JoltKeyBlockResult >();
+		pNewResult->Type = type;
+		pNewResult->Defaults.assign( pObjBytes, pObjBytes + size );
+
+		JoltRecordingKeyHandler recorder;
+		{
+			JoltKVSchemaWriteRecorder writeRecorder( pObj );
+			ParseJoltKVSchema( GetBlockProp(), pDescs, count, pObj, pObj, &recorder );
+			pNewResult->Reads = writeRecorder.GetReads();
+			pNewResult->Writes = writeRecorder.GetWrites();
+		}
+
+		pNewResult->Result.assign( pObjBytes, pObjBytes + size );
+		pNewResult->UnknownKeys = std::move( recorder.Keys );
+
+		// Pointers only make sense for the object they were written into, so leave them out.
+		std::vector< bool > pointer( size, false );
+		for ( size_t nOffset : pointerOffsets )
+			std::fill_n( pointer.begin() + nOffset, sizeof( void * ), true );
+
+		EraseIf( pNewResult->Writes, [ &pointer ]( const JoltKVSchemaWriteRecorder::Range &range )
+		{
+			return std::find( pointer.begin() + range.first, pointer.begin() + range.first + range.second, true ) != pointer.begin() + range.first + range.second;
+		} );
+
+		// Fixups can write to fields outside of the schema, pick those up from what changed.
+		std::vector< bool > written( pointer );
+		for ( const auto &[ nOffset, nSize ] : pNewResult->Writes )
+			std::fill_n( written.begin() + nOffset, nSize, true );
+
+		for ( size_t i = 0; i < size; )
+		{
+			if ( written[ i ] || pNewResult->Defaults[ i ] == pNewResult->Result[ i ] )
+			{
+				i++;
+				continue;
+			}
+
+			const size_t nStart = i;
+			while ( i < size && !written[ i ] && pNewResult->Defaults[ i ] != pNewResult->Result[ i ] )
+				i++;
+			pNewResult->Writes.emplace_back( nStart, i - nStart );
+		}
+		pResult = std::move( pNewResult );
+
+		std::unique_lock lock( s_KeyParseCacheLock );
+		block.pResult = pResult;
 	}
-	"collisionrules"
+
+	// Unknown keys always go to the handler after the schema is done with the
+	// object, so it looks the same to the game whether this was a replay or not.
+	if ( unknownKeyHandler )
 	{
-		"dummy" "1"
+		for ( const auto &[ key, value ] : pResult->UnknownKeys )
+			unknownKeyHandler->ParseKeyValue( pObj, key.c_str(), value.c_str() );
 	}
+
+	return pResult;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Cache
+//-------------------------------------------------------------------------------------------------
+
+static ConVar vjolt_keyparser_cache_size( "vjolt_keyparser_cache_size", "512", FCVAR_NONE, "Maximum number of distinct key data buffers to keep parse results for. 0 disables the cache." );
+
+// Most recently used at the front.
+static std::list< std::shared_ptr< JoltKeyParseCacheEntry > > s_KeyParseCache;
+static std::unordered_map< uint64, std::list< std::shared_ptr< JoltKeyParseCacheEntry > >::iterator > s_KeyParseCacheLookup;
+
+static uint s_nKeyParseCacheHits = 0;
+static uint s_nKeyParseCacheMisses = 0;
+static uint s_nKeyParseCacheEvictions = 0;
+
+static void TrimKeyParseCache( size_t nMaxEntries )
+{
+	while ( s_KeyParseCache.size() > nMaxEntries )
+	{
+		s_KeyParseCacheLookup.erase( s_KeyParseCache.back()->nHash );
+		s_KeyParseCache.pop_back();
+		s_nKeyParseCacheEvictions++;
+	}
+}
+
+static void PublishKeyParseCacheEntry( std::shared_ptr< JoltKeyParseCacheEntry > pEntry )
+{
+	const int nMaxEntries = vjolt_keyparser_cache_size.GetInt();
+	if ( nMaxEntries <= 0 )
+		return;
+
+	std::unique_lock lock( s_KeyParseCacheLock );
+
+	// Someone else may have parsed the same data at the same time,
+	// or it's a hash collision. Either way, newest wins.
+	auto lookup = s_KeyParseCacheLookup.find( pEntry->nHash );
+	if ( lookup != s_KeyParseCacheLookup.end() )
+		s_KeyParseCache.erase( lookup->second );
+
+	s_KeyParseCache.push_front( std::move( pEntry ) );
+	s_KeyParseCacheLookup[ s_KeyParseCache.front()->nHash ] = s_KeyParseCache.begin();
+
+	TrimKeyParseCache( size_t( nMaxEntries ) );
+}
+
+void InvalidateVPhysicsKeyParserCache()
+{
+	std::unique_lock lock( s_KeyParseCacheLock );
+
+	s_KeyParseCache.clear();
+	s_KeyParseCacheLookup.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+
+static std::shared_ptr< JoltKeyParseCacheEntry > CreateKeyParseCacheEntry( const char *pKeyData, size_t nLength, uint64 nHash )
+{
+	// Take our own copy, the game is free to throw away the key data
+	// before it is done with us.
+	auto pEntry = std::make_shared< JoltKeyParseCacheEntry >();
+	pEntry->nHash = nHash;
+	pEntry->KeyData.assign( pKeyData, nLength );
+	return pEntry;
 }
-)";
 
 IVPhysicsKeyParser *CreateVPhysicsKeyParser( const char *pKeyData, bool bIsPacked )
 {
@@ -511,21 +848,28 @@ IVPhysicsKeyParser *CreateVPhysicsKeyParser( const char *pKeyData, bool bIsPacke
 	if ( bIsPacked )
 		return nullptr;
 
-	KeyValues *pszKV = HeaderlessKVBufferToKeyValues( pKeyData, "VPhysicsKeyParse" );
+	if ( !pKeyData )
+		pKeyData = "";
+
+	const size_t nLength = V_strlen( pKeyData );
+	const uint64 nHash = JPH::HashBytes( pKeyData, uint( nLength ) );
 
-	// Josh: Ideally we would return nullptr here, but that breaks a lot of things.
-	// If we fail to parse the KV, simply just fall-back to a dummy KV that will cause things
-	// to get zero-initialized.
-	// In the future, we may want to add a KV patching pass to fix up broken model and vehicle data.
-	if ( !pszKV )
 	{
-		Log_Warning( LOG_VJolt, "CreateVPhysicsKeyParser: Encountered invalid KV data. Falling back to a dummy KV. You may notice a broken prop/vehicle.\n" );
+		std::unique_lock lock( s_KeyParseCacheLock );
+
+		auto lookup = s_KeyParseCacheLookup.find( nHash );
+		if ( lookup != s_KeyParseCacheLookup.end() && ( *lookup->second )->KeyData == std::string_view( pKeyData, nLength ) )
+		{
+			s_KeyParseCache.splice( s_KeyParseCache.begin(), s_KeyParseCache, lookup->second );
+			s_nKeyParseCacheHits++;
+
+			return new JoltPhysicsParseKV( s_KeyParseCache.front(), true );
+		}
 
-		pszKV = new KeyValues( "VPhysicsKeyParse_Fallback" );
-		pszKV->LoadFromBuffer( "VPhysicsKeyParse_Fallback", DummyParserKeyValues );
+		s_nKeyParseCacheMisses++;
 	}
 
-	return new JoltPhysicsParseKV( pszKV );
+	return new JoltPhysicsParseKV( CreateKeyParseCacheEntry( pKeyData, nLength, nHash ), false );
 }
 
 void DestroyVPhysicsKeyParser( IVPhysicsKeyParser *pParser )
@@ -533,3 +877,327 @@ void DestroyVPhysicsKeyParser( IVPhysicsKeyParser *pParser )
 	JoltPhysicsParseKV *pJoltParser = static_cast< JoltPhysicsParseKV * >( pParser );
 	delete pJoltParser;
 }
+
+CON_COMMAND( vjolt_keyparser_cache_stats, "Prints hit/miss counters for the key parser cache" )
+{
+	std::unique_lock lock( s_KeyParseCacheLock );
+
+	const uint nLookups = s_nKeyParseCacheHits + s_nKeyParseCacheMisses;
+	Log_Msg( LOG_VJolt, "Key parser cache: %u entries, %u hits, %u misses (%.1f%% hit rate), %u evictions, %u blocks replayed\n",
+		uint( s_KeyParseCache.size() ), s_nKeyParseCacheHits, s_nKeyParseCacheMisses,
+		nLookups ? 100.0f * s_nKeyParseCacheHits / nLookups : 0.0f,
+		s_nKeyParseCacheEvictions, s_nKeyParseBlockReplays );
+}
+
+CON_COMMAND( vjolt_keyparser_cache_clear, "Empties the key parser cache and resets its counters" )
+{
+	InvalidateVPhysicsKeyParserCache();
+
+	std::unique_lock lock( s_KeyParseCacheLock );
+	s_nKeyParseCacheHits = 0;
+	s_nKeyParseCacheMisses = 0;
+	s_nKeyParseCacheEvictions = 0;
+	s_nKeyParseBlockReplays = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Benchmark
+//-------------------------------------------------------------------------------------------------
+
+// A small corpus of key data in the shape studiomdl and the vehicle scripts emit it.
+static constexpr const char *kKeyParserBenchmarkCorpus[] =
+{
+	// Single solid prop
+	R"(solid {
+"index" "0"
+"mass" "35.000000"
+"surfaceprop" "wood_crate"
+"damping" "0.000000"
+"rotdamping" "0.000000"
+"inertia" "1.000000"
+"volume" "13824.000000"
+}
+editparams {
+"rootname" ""
+"totalmass" "35.000000"
+"concave" "1"
+}
+)",
+
+	// Ragdoll
+	R"(solid {
+"index" "0"
+"name" "ValveBiped.Bip01_Pelvis"
+"mass" "12.741364"
+"surfaceprop" "flesh"
+"damping" "0.000000"
+"rotdamping" "0.000000"
+"inertia" "10.000000"
+"volume" "1528.963501"
+}
+solid {
+"index" "1"
+"name" "ValveBiped.Bip01_Spine2"
+"parent" "ValveBiped.Bip01_Pelvis"
+"mass" "24.557726"
+"surfaceprop" "flesh"
+"damping" "0.000000"
+"rotdamping" "0.000000"
+"inertia" "10.000000"
+"volume" "2946.927246"
+}
+solid {
+"index" "2"
+"name" "ValveBiped.Bip01_Head1"
+"parent" "ValveBiped.Bip01_Spine2"
+"mass" "5.169795"
+"surfaceprop" "flesh"
+"damping" "0.000000"
+"rotdamping" "0.000000"
+"inertia" "10.000000"
+"volume" "620.375427"
+"massCenterOverride" "0.5 -1.25 3.0"
+}
+ragdollconstraint {
+"parent" "0"
+"child" "1"
+"xmin" "-20.000000"
+"xmax" "20.000000"
+"xfriction" "0.000000"
+"ymin" "-25.000000"
+"ymax" "25.000000"
+"yfriction" "0.000000"
+"zmin" "-15.000000"
+"zmax" "38.000000"
+"zfriction" "0.000000"
+}
+ragdollconstraint {
+"parent" "1"
+"child" "2"
+"xmin" "-20.000000"
+"xmax" "20.000000"
+"xfriction" "0.000000"
+"ymin" "-25.000000"
+"ymax" "25.000000"
+"yfriction" "0.000000"
+"zmin" "-13.000000"
+"zmax" "30.000000"
+"zfriction" "0.000000"
+}
+collisionrules {
+"selfcollisions" "0"
+}
+editparams {
+"rootname" ""
+"totalmass" "90.000000"
+"jointmerge" "ValveBiped.Bip01_Pelvis,ValveBiped.Bip01_Spine1"
+"concave" "1"
+}
+)",
+
+	// Vehicle script
+	R"("vehicle"
+{
+	"wheelsperaxle"	"2"
+	"body"
+	{
+		"countertorquefactor"	"1"
+		"massCenterOverride"	"0 -11 12"
+		"massoverride"			"1600"		// kg
+		"addgravity"			"0.33"
+	}
+	"engine"
+	{
+		"horsepower"		"350"
+		"maxrpm"			"3000"
+		"maxspeed"			"35"		// mph
+		"maxReverseSpeed"	"8"			// mph
+		"autotransmission"	"1"
+		"axleratio"			"4.56"
+		"gear"				"2.8"
+		"gear"				"1.8"
+		"gear"				"1.3"
+		"gear"				"1.0"
+		"shiftuprpm"		"2000"
+		"shiftdownrpm"		"1300"
+
+		"boost"
+		{
+			"force"			"1.5"
+			"duration"		"1.0"
+			"delay"			"15"
+			"torqueboost"	"1"
+			"maxspeed"		"50"
+		}
+	}
+	"steering"
+	{
+		"degreesSlow"		"30"
+		"degreesFast"		"12"
+		"degreesBoost"		"5"
+		"steeringExponent"	"1.4"
+		"slowcarspeed"		"14"
+		"fastcarspeed"		"20"
+		"slowSteeringRate"	"4.0"
+		"fastSteeringRate"	"2.0"
+		"steeringRestRateSlow"	"4.0"
+		"steeringRestRateFast"	"2.0"
+		"turnThrottleReduceSlow" "0.01"
+		"turnThrottleReduceFast" "2.0"
+		"brakeSteeringRateFactor"	"6"
+		"throttleSteeringRestRateFactor"	"2"
+		"boostSteeringRestRateFactor"	"1.7"
+		"boostSteeringRateFactor"	"1.7"
+		"powerSlideAccel"	"250"
+		"skidallowed"		"1"
+		"dustcloud"		"1"
+	}
+	"axle"
+	{
+		"wheel"
+		{
+			"radius"	"18"
+			"mass"		"100"
+			"inertia"	"0.5"
+			"damping"	"0"
+			"rotdamping"	"0.0"
+			"material"	"jeeptire"
+			"skidmaterial"	"slidingrubbertire"
+			"brakematerial" "brakingrubbertire"
+		}
+		"suspension"
+		{
+			"springConstant"		"160"
+			"springDamping"			"0.3"
+			"stabilizerConstant"		"110"
+			"springDampingCompression"	"4.7"
+			"maxBodyForce"			"20"
+		}
+		"torquefactor"	"1.0"
+		"brakefactor"	"0.5"
+	}
+	"axle"
+	{
+		"wheel"
+		{
+			"radius"	"18"
+			"mass"		"100"
+			"inertia"	"0.5"
+			"damping"	"0"
+			"rotdamping"	"0.0"
+			"material"	"jeeptire"
+			"skidmaterial"	"slidingrubbertire"
+			"brakematerial" "brakingrubbertire"
+		}
+		"suspension"
+		{
+			"springConstant"		"160"
+			"springDamping"			"0.3"
+			"stabilizerConstant"		"110"
+			"springDampingCompression"	"4.7"
+			"maxBodyForce"			"20"
+		}
+		"torquefactor"	"1.0"
+		"brakefactor"	"0.5"
+	}
+}
+
+"vehicle_sounds"
+{
+	"gear"
+	{
+		"max_speed"		"0.3"
+		"speed_approach_factor" "1.0"
+	}
+	"state"
+	{
+		"name"		"SS_START_WATER"
+		"sound"		"ATV_start_in_water"
+	}
+}
+)",
+};
+
+static constexpr size_t kKeyParserBenchmarkCorpusSize = std::size( kKeyParserBenchmarkCorpus );
+
+// The benchmark keeps its own entries, rather than going through CreateVPhysicsKeyParser,
+// so running it on a live server doesn't throw away or skew the real cache.
+// Entries that are null get parsed from scratch, and filled in if pEntries is given.
+static void ParseKeyParserBenchmarkCorpus( std::shared_ptr< JoltKeyParseCacheEntry > *pEntries )
+{
+	for ( size_t i = 0; i < kKeyParserBenchmarkCorpusSize; i++ )
+	{
+		const char *pszKeyData = kKeyParserBenchmarkCorpus[ i ];
+
+		const bool bCached = pEntries && pEntries[ i ];
+		std::shared_ptr< JoltKeyParseCacheEntry > pEntry = bCached
+			? pEntries[ i ]
+			: CreateKeyParseCacheEntry( pszKeyData, V_strlen( pszKeyData ), 0 );
+
+		JoltPhysicsParseKV parser( pEntry, bCached, false );
+		IVPhysicsKeyParser *pParser = &parser;
+		while ( !pParser->Finished() )
+		{
+			const char *pszBlockName = pParser->GetCurrentBlockName();
+			if ( !V_stricmp( pszBlockName, "solid" ) )
+			{
+				solid_t solid;
+				pParser->ParseSolid( &solid, nullptr );
+			}
+			else if ( !V_stricmp( pszBlockName, "ragdollconstraint" ) )
+			{
+				constraint_ragdollparams_t constraint;
+				pParser->ParseRagdollConstraint( &constraint, nullptr );
+			}
+			else if ( !V_stricmp( pszBlockName, "vehicle" ) )
+			{
+				vehicleparams_t vehicle;
+				pParser->ParseVehicle( &vehicle, nullptr );
+			}
+			else
+			{
+				pParser->SkipBlock();
+			}
+		}
+
+		if ( pEntries )
+			pEntries[ i ] = std::move( pEntry );
+	}
+}
+
+CON_COMMAND( vjolt_keyparser_benchmark, "Times the key parser over a built-in corpus of model key data, with and without the cache, against building a KeyValues tree of the same data" )
+{
+	const int nIterations = args.ArgC() > 1 ? Max( V_atoi( args[ 1 ] ), 1 ) : 10000;
+
+	const double flParseStart = Plat_FloatTime();
+	for ( int i = 0; i < nIterations; i++ )
+		ParseKeyParserBenchmarkCorpus( nullptr );
+	const double flParseTime = Plat_FloatTime() - flParseStart;
+
+	// Fill our private cache before timing it.
+	std::shared_ptr< JoltKeyParseCacheEntry > cachedEntries[ kKeyParserBenchmarkCorpusSize ];
+	ParseKeyParserBenchmarkCorpus( cachedEntries );
+
+	const double flCachedStart = Plat_FloatTime();
+	for ( int i = 0; i < nIterations; i++ )
+		ParseKeyParserBenchmarkCorpus( cachedEntries );
+	const double flCachedTime = Plat_FloatTime() - flCachedStart;
+
+	// What every parse used to pay up front before reading a single value.
+	const double flTreeStart = Plat_FloatTime();
+	for ( int i = 0; i < nIterations; i++ )
+	{
+		for ( const char *pszKeyData : kKeyParserBenchmarkCorpus )
+		{
+			KeyValues *pKV = HeaderlessKVBufferToKeyValues( pszKeyData, "VPhysicsKeyParse" );
+			if ( pKV )
+				pKV->deleteThis();
+		}
+	}
+	const double flTreeTime = Plat_FloatTime() - flTreeStart;
+
+	const int nParses = nIterations * int( kKeyParserBenchmarkCorpusSize );
+	Log_Msg( LOG_VJolt, "Key parser: %d parses in %.3f ms (%.3f us each)\n", nParses, flParseTime * 1000.0, flParseTime * 1e6 / nParses );
+	Log_Msg( LOG_VJolt, "Key parser (cached): %d parses in %.3f ms (%.3f us each)\n", nParses, flCachedTime * 1000.0, flCachedTime * 1e6 / nParses );
+	Log_Msg( LOG_VJolt, "KeyValues tree only: %d parses in %.3f ms (%.3f us each)\n", nParses, flTreeTime * 1000.0, flTreeTime * 1e6 / nParses );
+}
@@ -7,3 +7,6 @@ class IVPhysicsKeyParser;
 
 IVPhysicsKeyParser* CreateVPhysicsKeyParser( const char* pKeyData, bool bIsPacked );
 void DestroyVPhysicsKeyParser( IVPhysicsKeyParser* pParser );
+
+// Forgets all cached parse results, e.g. when surface indices may have changed.
+void InvalidateVPhysicsKeyParserCache();
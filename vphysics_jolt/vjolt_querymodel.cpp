@@ -1,6 +1,8 @@
 
 #include "cbase.h"
 
+#include "vjolt_collide.h"
+
 #include "vjolt_querymodel.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
@@ -13,6 +15,11 @@ JoltCollisionQuery::JoltCollisionQuery( JPH::Shape *pShape )
 {
 }
 
+JoltCollisionQuery::~JoltCollisionQuery()
+{
+	ReleaseCollideInfo( m_pShape );
+}
+
 //-------------------------------------------------------------------------------------------------
 
 int JoltCollisionQuery::ConvexCount()
@@ -5,6 +5,7 @@ class JoltCollisionQuery final : public ICollisionQuery
 {
 public:
 	JoltCollisionQuery( JPH::Shape *pShape );
+	~JoltCollisionQuery();
 
 	int				ConvexCount() override;
 	int				TriangleCount( int convexIndex ) override;
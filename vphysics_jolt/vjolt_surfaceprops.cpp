@@ -3,6 +3,7 @@
 
 #include "vjolt_interface.h"
 #include "vjolt_keyvalues_schema.h"
+#include "vjolt_parse.h"
 
 #include "vjolt_surfaceprops.h"
 
@@ -98,17 +99,20 @@ JoltPhysicsSurfaceProps::JoltPhysicsSurfaceProps()
 	prop.data.physics.thickness		= 0.0f;
 	prop.data.physics.dampening		= 0.0f;
 	m_SurfaceProps[ "default" ] = prop;
+
+	m_WorldMaterialTable.fill( -1 );
 }
 
 //-------------------------------------------------------------------------------------------------
 
 int JoltPhysicsSurfaceProps::ParseSurfaceData( const char *pFilename, const char *pTextfile )
 {
-	KeyValues::AutoDelete kv( SurfacePropsToKeyValues( pTextfile ) );
+	JoltKVReader reader( pTextfile );
 
-	for ( KeyValues* pSurface = kv->GetFirstSubKey(); pSurface != nullptr; pSurface = pSurface->GetNextKey() )
+	JoltKVProp surface;
+	while ( reader.GetRoot()->NextSubKey( &surface ) )
 	{
-		const char *pSurfaceName = pSurface->GetName();
+		const char *pSurfaceName = surface.GetName();
 
 		JoltSurfaceProp values = {};
 		// Try to find it if we already have a material with this name,
@@ -119,7 +123,7 @@ int JoltPhysicsSurfaceProps::ParseSurfaceData( const char *pFilename, const char
 		else
 			values = m_SurfaceProps[ BaseMaterialIdx ];
 
-		ParseJoltKVSchema( pSurface, kSurfacePropDescs, uint( std::size( kSurfacePropDescs ) ), &values );
+		ParseJoltKVSchema( &surface, kSurfacePropDescs, uint( std::size( kSurfacePropDescs ) ), &values );
 
 		// If we don't have this already, add it,
 		// otherwise update the values.
@@ -129,6 +133,9 @@ int JoltPhysicsSurfaceProps::ParseSurfaceData( const char *pFilename, const char
 			m_SurfaceProps[ id ] = values;
 	}
 
+	// Vehicle wheels keep the surface indices they were parsed with.
+	InvalidateVPhysicsKeyParserCache();
+
 	return m_SurfaceProps.GetNumStrings();
 }
 
@@ -193,7 +200,45 @@ const char *JoltPhysicsSurfaceProps::GetPropName( int surfaceDataIndex ) const
 
 void JoltPhysicsSurfaceProps::SetWorldMaterialIndexTable( int *pMapArray, int mapSize )
 {
-	Log_Stub( LOG_VJolt );
+	// Only 7 bits of material index on a triangle, anything past that can't be referenced.
+	mapSize = pMapArray ? Min( mapSize, kMaxWorldMaterials ) : 0;
+
+	// The materials on the world triangles look this up on every contact,
+	// so meshes built before the table arrived pick it up too.
+	m_WorldMaterialTable.fill( -1 );
+	for ( int i = 0; i < mapSize; i++ )
+		m_WorldMaterialTable[ i ] = pMapArray[ i ];
+}
+
+const JPH::PhysicsMaterial *JoltPhysicsSurfaceProps::GetWorldMaterial( int nWorldMaterialIndex )
+{
+	if ( nWorldMaterialIndex <= 0 || nWorldMaterialIndex >= kMaxWorldMaterials )
+		return JPH::PhysicsMaterial::sDefault;
+
+	std::unique_lock lock( m_MaterialsLock );
+
+	JPH::Ref< JoltPhysicsMaterial > &pMaterial = m_WorldMaterials[ nWorldMaterialIndex ];
+	if ( pMaterial == nullptr )
+		pMaterial = new JoltPhysicsMaterial( nWorldMaterialIndex, -1 );
+
+	return pMaterial;
+}
+
+const JPH::PhysicsMaterial *JoltPhysicsSurfaceProps::GetSurfaceMaterial( int nSurfaceIndex )
+{
+	if ( nSurfaceIndex < 0 )
+		return JPH::PhysicsMaterial::sDefault;
+
+	std::unique_lock lock( m_MaterialsLock );
+
+	if ( nSurfaceIndex >= int( m_SurfaceMaterials.size() ) )
+		m_SurfaceMaterials.resize( nSurfaceIndex + 1 );
+
+	JPH::Ref< JoltPhysicsMaterial > &pMaterial = m_SurfaceMaterials[ nSurfaceIndex ];
+	if ( pMaterial == nullptr )
+		pMaterial = new JoltPhysicsMaterial( -1, nSurfaceIndex );
+
+	return pMaterial;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -227,13 +272,6 @@ unsigned short JoltPhysicsSurfaceProps::RegisterSound( const char *pName )
 
 //-------------------------------------------------------------------------------------------------
 
-KeyValues *JoltPhysicsSurfaceProps::SurfacePropsToKeyValues( const char *pszBuffer )
-{
-	return HeaderlessKVBufferToKeyValues( pszBuffer, "PhysProps" );
-}
-
-//-------------------------------------------------------------------------------------------------
-
 void *JoltPhysicsSurfaceProps::GetIVPMaterial( int nIndex )
 {
 	Log_Stub( LOG_VJolt );
@@ -6,6 +6,26 @@ struct JoltSurfaceProp
 	surfacedata_t data;
 };
 
+// Material we hand to Jolt for world geometry, so contacts can be
+// resolved back to a surface prop without going near any strings.
+// Refers to either an entry in the world material table, or directly to a surface prop.
+class JoltPhysicsMaterial final : public JPH::PhysicsMaterial
+{
+public:
+	JoltPhysicsMaterial( int nWorldMaterialIndex, int nSurfaceIndex )
+		: m_nWorldMaterialIndex( nWorldMaterialIndex )
+		, m_nSurfaceIndex( nSurfaceIndex )
+	{
+	}
+
+	int GetWorldMaterialIndex() const	{ return m_nWorldMaterialIndex; }
+	int GetSurfaceIndex() const			{ return m_nSurfaceIndex; }
+
+private:
+	int m_nWorldMaterialIndex;
+	int m_nSurfaceIndex;
+};
+
 class JoltPhysicsMaterialIndexSaveOps : public CDefSaveRestoreOps
 {
 public:
@@ -55,13 +75,50 @@ public:
 
 	unsigned short		RegisterSound( const char *pName );
 
+	// Material for triangles tagged with a 7-bit world material index,
+	// 0 is left to use the material of the object itself.
+	const JPH::PhysicsMaterial *GetWorldMaterial( int nWorldMaterialIndex );
+	// Material for geometry of a single known surface prop.
+	const JPH::PhysicsMaterial *GetSurfaceMaterial( int nSurfaceIndex );
+
+	// Resolves a material from a shape back to a surface prop,
+	// -1 if the object's own should be used.
+	int					GetMaterialSurfaceIndex( const JPH::PhysicsMaterial *pMaterial ) const
+	{
+		// Every material other than the default in our shapes is one of ours.
+		if ( pMaterial == nullptr || pMaterial == JPH::PhysicsMaterial::sDefault )
+			return -1;
+
+		const JoltPhysicsMaterial *pJoltMaterial = static_cast< const JoltPhysicsMaterial * >( pMaterial );
+		const int nWorldMaterialIndex = pJoltMaterial->GetWorldMaterialIndex();
+		return nWorldMaterialIndex >= 0 ? m_WorldMaterialTable[ nWorldMaterialIndex ] : pJoltMaterial->GetSurfaceIndex();
+	}
+
+	const surfacephysicsparams_t &GetPhysicsParams( int surfaceDataIndex ) const
+	{
+		const UtlSymId_t id = surfaceDataIndex >= 0 && surfaceDataIndex < int( m_SurfaceProps.GetNumStrings() )
+			? UtlSymId_t( surfaceDataIndex )
+			: BaseMaterialIdx;
+
+		return m_SurfaceProps[ id ].data.physics;
+	}
+
 private:
 	static JoltPhysicsSurfaceProps s_PhysicsSurfaceProps;
 
 	CUtlStringMap< JoltSurfaceProp >	m_SurfaceProps;
 	CUtlSymbolTable						m_SoundStrings;
+
+	static constexpr int kMaxWorldMaterials = 128;
+
+	// Maps the 7-bit material indices on world triangles to surface props.
+	// Entries the game didn't give us are -1.
+	std::array< int, kMaxWorldMaterials >	m_WorldMaterialTable;
+
+	// Created on demand, we can't allocate through Jolt this early on.
+	std::mutex														m_MaterialsLock;
+	std::array< JPH::Ref< JoltPhysicsMaterial >, kMaxWorldMaterials >	m_WorldMaterials;
+	std::vector< JPH::Ref< JoltPhysicsMaterial > >					m_SurfaceMaterials;
 	
 	static constexpr UtlSymId_t BaseMaterialIdx = UtlSymId_t( 0 );
-
-	KeyValues *SurfacePropsToKeyValues( const char *pszBuffer );
 };
@@ -0,0 +1,596 @@
+//=================================================================================================
+//
+// A vehicle wheel, a proxy over the wheel state of a vehicle constraint
+//
+//=================================================================================================
+
+#include "cbase.h"
+
+#include "vjolt_collide.h"
+#include "vjolt_controller_vehicle.h"
+#include "vjolt_friction.h"
+
+#include "vjolt_vehicle_wheel.h"
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+//-------------------------------------------------------------------------------------------------
+
+JoltPhysicsVehicleWheel::JoltPhysicsVehicleWheel( JoltPhysicsVehicleController *pController, int nWheelIndex, float flRadius, int nMaterialIndex, const objectparams_t &params )
+	: m_pGameData( params.pGameData )
+	, m_pController( pController )
+	, m_nWheelIndex( nWheelIndex )
+	, m_pShape( new JPH::SphereShape( SourceToJolt::Distance( flRadius ) ) )
+	, m_materialIndex( nMaterialIndex )
+	, m_flRadius( flRadius )
+	, m_flMass( params.mass )
+	, m_flDamping( params.damping )
+	, m_flRotDamping( params.rotdamping )
+{
+	// See JoltPhysicsObject, the game may read m_pGameData directly.
+	static_assert( offsetof( JoltPhysicsVehicleWheel, m_pGameData ) == sizeof( void * ) );
+}
+
+JoltPhysicsVehicleWheel::~JoltPhysicsVehicleWheel()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+bool JoltPhysicsVehicleWheel::IsStatic() const
+{
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsAsleep() const
+{
+	JoltPhysicsObject *pCarBody = GetCarBodyObject();
+	return !pCarBody || pCarBody->IsAsleep();
+}
+
+bool JoltPhysicsVehicleWheel::IsTrigger() const
+{
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsFluid() const
+{
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsHinged() const
+{
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsCollisionEnabled() const
+{
+	// The vehicle constraint does all the colliding for us.
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsGravityEnabled() const
+{
+	return true;
+}
+
+bool JoltPhysicsVehicleWheel::IsDragEnabled() const
+{
+	return false;
+}
+
+bool JoltPhysicsVehicleWheel::IsMotionEnabled() const
+{
+	JoltPhysicsObject *pCarBody = GetCarBodyObject();
+	return pCarBody && pCarBody->IsMotionEnabled();
+}
+
+bool JoltPhysicsVehicleWheel::IsMoveable() const
+{
+	return IsMotionEnabled();
+}
+
+bool JoltPhysicsVehicleWheel::IsAttachedToConstraint( bool bExternalOnly ) const
+{
+	// We are always attached to our vehicle, but that is not external.
+	return !bExternalOnly;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::EnableCollisions( bool enable )
+{
+}
+
+void JoltPhysicsVehicleWheel::EnableGravity( bool enable )
+{
+}
+
+void JoltPhysicsVehicleWheel::EnableDrag( bool enable )
+{
+}
+
+void JoltPhysicsVehicleWheel::EnableMotion( bool enable )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetGameData( void *pGameData )
+{
+	m_pGameData = pGameData;
+}
+
+void *JoltPhysicsVehicleWheel::GetGameData() const
+{
+	return m_pGameData;
+}
+
+void JoltPhysicsVehicleWheel::SetGameFlags( unsigned short userFlags )
+{
+	m_gameFlags = userFlags;
+}
+
+unsigned short JoltPhysicsVehicleWheel::GetGameFlags() const
+{
+	return m_gameFlags;
+}
+
+void JoltPhysicsVehicleWheel::SetGameIndex( unsigned short gameIndex )
+{
+	m_gameIndex = gameIndex;
+}
+
+unsigned short JoltPhysicsVehicleWheel::GetGameIndex() const
+{
+	return m_gameIndex;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetCallbackFlags( unsigned short callbackflags )
+{
+	// Keep the wheel flag, it is how we tell wheels apart from real objects.
+	m_callbackFlags = callbackflags | CALLBACK_IS_VEHICLE_WHEEL;
+}
+
+unsigned short JoltPhysicsVehicleWheel::GetCallbackFlags() const
+{
+	return m_callbackFlags;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::Wake()
+{
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+		pCarBody->Wake();
+}
+
+void JoltPhysicsVehicleWheel::Sleep()
+{
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+		pCarBody->Sleep();
+}
+
+void JoltPhysicsVehicleWheel::RecheckCollisionFilter()
+{
+}
+
+void JoltPhysicsVehicleWheel::RecheckContactPoints( bool bSearchForNewContacts )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetMass( float mass )
+{
+	m_flMass = mass;
+}
+
+float JoltPhysicsVehicleWheel::GetMass() const
+{
+	return m_flMass;
+}
+
+float JoltPhysicsVehicleWheel::GetInvMass() const
+{
+	return m_flMass ? 1.0f / m_flMass : 0.0f;
+}
+
+Vector JoltPhysicsVehicleWheel::GetInertia() const
+{
+	// Solid sphere, same as the old wheel objects.
+	const float flInertia = 0.4f * m_flMass * Square( SourceToJolt::Distance( m_flRadius ) );
+	return Vector( flInertia, flInertia, flInertia );
+}
+
+Vector JoltPhysicsVehicleWheel::GetInvInertia() const
+{
+	const Vector inertia = GetInertia();
+	return inertia.x ? Vector( 1.0f / inertia.x, 1.0f / inertia.y, 1.0f / inertia.z ) : vec3_origin;
+}
+
+void JoltPhysicsVehicleWheel::SetInertia( const Vector &inertia )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetDamping( const float *speed, const float *rot )
+{
+	if ( speed )
+		m_flDamping = *speed;
+
+	if ( rot )
+		m_flRotDamping = *rot;
+}
+
+void JoltPhysicsVehicleWheel::GetDamping( float *speed, float *rot ) const
+{
+	if ( speed )
+		*speed = m_flDamping;
+
+	if ( rot )
+		*rot = m_flRotDamping;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetDragCoefficient( float *pDrag, float *pAngularDrag )
+{
+}
+
+void JoltPhysicsVehicleWheel::SetBuoyancyRatio( float ratio )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int JoltPhysicsVehicleWheel::GetMaterialIndex() const
+{
+	return m_materialIndex;
+}
+
+void JoltPhysicsVehicleWheel::SetMaterialIndex( int materialIndex )
+{
+	m_materialIndex = materialIndex;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+unsigned int JoltPhysicsVehicleWheel::GetContents() const
+{
+	return m_contents;
+}
+
+void JoltPhysicsVehicleWheel::SetContents( unsigned int contents )
+{
+	m_contents = contents;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+float JoltPhysicsVehicleWheel::GetSphereRadius() const
+{
+	return m_flRadius;
+}
+
+void JoltPhysicsVehicleWheel::SetSphereRadius( float radius )
+{
+}
+
+float JoltPhysicsVehicleWheel::GetEnergy() const
+{
+	// The energy is all in the car.
+	return 0.0f;
+}
+
+Vector JoltPhysicsVehicleWheel::GetMassCenterLocalSpace() const
+{
+	return vec3_origin;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetPosition( const Vector &worldPosition, const QAngle &angles, bool isTeleport )
+{
+	// The vehicle constraint decides where we are.
+}
+
+void JoltPhysicsVehicleWheel::SetPositionMatrix( const matrix3x4_t &matrix, bool isTeleport )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::GetPosition( Vector *worldPosition, QAngle *angles ) const
+{
+	const JPH::Mat44 wheelTransform = GetWheelTransform();
+
+	if ( worldPosition )
+		*worldPosition = JoltToSource::Distance( wheelTransform.GetTranslation() );
+
+	if ( angles )
+		*angles = JoltToSource::Angle( wheelTransform.GetRotation().GetQuaternion() );
+}
+
+void JoltPhysicsVehicleWheel::GetPositionMatrix( matrix3x4_t *positionMatrix ) const
+{
+	const JPH::Mat44 wheelTransform = GetWheelTransform();
+
+	matrix3x4_t matrix;
+	SetIdentityMatrix( matrix );
+	AngleMatrix( JoltToSource::Angle( wheelTransform.GetRotation().GetQuaternion() ), JoltToSource::Distance( wheelTransform.GetTranslation() ), matrix );
+	*positionMatrix = matrix;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetVelocity( const Vector *velocity, const AngularImpulse *angularVelocity )
+{
+}
+
+void JoltPhysicsVehicleWheel::SetVelocityInstantaneous( const Vector *velocity, const AngularImpulse *angularVelocity )
+{
+}
+
+void JoltPhysicsVehicleWheel::GetVelocity( Vector *velocity, AngularImpulse *angularVelocity ) const
+{
+	JoltPhysicsObject *pCarBody = GetCarBodyObject();
+
+	if ( velocity )
+	{
+		*velocity = vec3_origin;
+		if ( pCarBody )
+			pCarBody->GetVelocityAtPoint( JoltToSource::Distance( GetWheelTransform().GetTranslation() ), velocity );
+	}
+
+	// Local space, we only ever spin around our axle.
+	if ( angularVelocity )
+	{
+		*angularVelocity = vec3_origin;
+		if ( pCarBody )
+			angularVelocity->x = JoltToSource::Angle( m_pController->GetWheelAngularVelocity( m_nWheelIndex ) );
+	}
+}
+
+void JoltPhysicsVehicleWheel::AddVelocity( const Vector *velocity, const AngularImpulse *angularVelocity )
+{
+}
+
+void JoltPhysicsVehicleWheel::GetVelocityAtPoint( const Vector &worldPosition, Vector *pVelocity ) const
+{
+	VJoltAssert( pVelocity );
+
+	*pVelocity = vec3_origin;
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+		pCarBody->GetVelocityAtPoint( worldPosition, pVelocity );
+}
+
+void JoltPhysicsVehicleWheel::GetImplicitVelocity( Vector *velocity, AngularImpulse *angularVelocity ) const
+{
+	GetVelocity( velocity, angularVelocity );
+}
+
+void JoltPhysicsVehicleWheel::LocalToWorld( Vector *worldPosition, const Vector &localPosition ) const
+{
+	matrix3x4_t matrix;
+	GetPositionMatrix( &matrix );
+	// Copy in case src == dest
+	VectorTransform( Vector( localPosition ), matrix, *worldPosition );
+}
+
+void JoltPhysicsVehicleWheel::WorldToLocal( Vector *localPosition, const Vector &worldPosition ) const
+{
+	matrix3x4_t matrix;
+	GetPositionMatrix( &matrix );
+	// Copy in case src == dest
+	VectorITransform( Vector( worldPosition ), matrix, *localPosition );
+}
+
+void JoltPhysicsVehicleWheel::LocalToWorldVector( Vector *worldVector, const Vector &localVector ) const
+{
+	matrix3x4_t matrix;
+	GetPositionMatrix( &matrix );
+	// Copy in case src == dest
+	VectorRotate( Vector( localVector ), matrix, *worldVector );
+}
+
+void JoltPhysicsVehicleWheel::WorldToLocalVector( Vector *localVector, const Vector &worldVector ) const
+{
+	matrix3x4_t matrix;
+	GetPositionMatrix( &matrix );
+	// Copy in case src == dest
+	VectorIRotate( Vector( worldVector ), matrix, *localVector );
+}
+
+//-------------------------------------------------------------------------------------------------
+
+// Forces on a wheel end up on the car, at the wheel.
+
+void JoltPhysicsVehicleWheel::ApplyForceCenter( const Vector &forceVector )
+{
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+		pCarBody->ApplyForceOffset( forceVector, JoltToSource::Distance( GetWheelTransform().GetTranslation() ) );
+}
+
+void JoltPhysicsVehicleWheel::ApplyForceOffset( const Vector &forceVector, const Vector &worldPosition )
+{
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+		pCarBody->ApplyForceOffset( forceVector, worldPosition );
+}
+
+void JoltPhysicsVehicleWheel::ApplyTorqueCenter( const AngularImpulse &torque )
+{
+}
+
+void JoltPhysicsVehicleWheel::CalculateForceOffset( const Vector &forceVector, const Vector &worldPosition, Vector *centerForce, AngularImpulse *centerTorque ) const
+{
+	if ( centerForce )
+		*centerForce = forceVector;
+
+	if ( centerTorque )
+		*centerTorque = vec3_origin;
+}
+
+void JoltPhysicsVehicleWheel::CalculateVelocityOffset( const Vector &forceVector, const Vector &worldPosition, Vector *centerVelocity, AngularImpulse *centerAngularVelocity ) const
+{
+	if ( JoltPhysicsObject *pCarBody = GetCarBodyObject() )
+	{
+		pCarBody->CalculateVelocityOffset( forceVector, worldPosition, centerVelocity, centerAngularVelocity );
+		return;
+	}
+
+	if ( centerVelocity )
+		*centerVelocity = vec3_origin;
+
+	if ( centerAngularVelocity )
+		*centerAngularVelocity = vec3_origin;
+}
+
+float JoltPhysicsVehicleWheel::CalculateLinearDrag( const Vector &unitDirection ) const
+{
+	return 0.0f;
+}
+
+float JoltPhysicsVehicleWheel::CalculateAngularDrag( const Vector &objectSpaceRotationAxis ) const
+{
+	return 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+bool JoltPhysicsVehicleWheel::GetContactPoint( Vector *contactPoint, IPhysicsObject **contactObject ) const
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetShadow( float maxSpeed, float maxAngularSpeed, bool allowPhysicsMovement, bool allowPhysicsRotation )
+{
+}
+
+void JoltPhysicsVehicleWheel::UpdateShadow( const Vector &targetPosition, const QAngle &targetAngles, bool tempDisableGravity, float timeOffset )
+{
+}
+
+int JoltPhysicsVehicleWheel::GetShadowPosition( Vector *position, QAngle *angles ) const
+{
+	GetPosition( position, angles );
+	return 0;
+}
+
+IPhysicsShadowController *JoltPhysicsVehicleWheel::GetShadowController() const
+{
+	return nullptr;
+}
+
+void JoltPhysicsVehicleWheel::RemoveShadowController()
+{
+}
+
+float JoltPhysicsVehicleWheel::ComputeShadowControl( const hlshadowcontrol_params_t &params, float secondsToArrival, float dt )
+{
+	return 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+const CPhysCollide *JoltPhysicsVehicleWheel::GetCollide() const
+{
+	return CPhysCollide::FromShape( m_pShape.GetPtr() );
+}
+
+const char *JoltPhysicsVehicleWheel::GetName() const
+{
+	return "VehicleWheel";
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::BecomeTrigger()
+{
+}
+
+void JoltPhysicsVehicleWheel::RemoveTrigger()
+{
+}
+
+void JoltPhysicsVehicleWheel::BecomeHinged( int localAxis )
+{
+}
+
+void JoltPhysicsVehicleWheel::RemoveHinged()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+IPhysicsFrictionSnapshot *JoltPhysicsVehicleWheel::CreateFrictionSnapshot()
+{
+	return new JoltPhysicsFrictionSnapshot;
+}
+
+void JoltPhysicsVehicleWheel::DestroyFrictionSnapshot( IPhysicsFrictionSnapshot *pSnapshot )
+{
+	delete pSnapshot;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::OutputDebugInfo() const
+{
+	const JPH::Mat44 wheelTransform = GetWheelTransform();
+	const Vector vecPosition = JoltToSource::Distance( wheelTransform.GetTranslation() );
+	const QAngle angles = JoltToSource::Angle( wheelTransform.GetRotation().GetQuaternion() );
+
+	Log_Msg( LOG_VJolt, "Vehicle wheel %d: radius %g, mass %g\n", m_nWheelIndex, m_flRadius, m_flMass );
+	Log_Msg( LOG_VJolt, "  Position: %g %g %g\n", vecPosition.x, vecPosition.y, vecPosition.z );
+	Log_Msg( LOG_VJolt, "  Angles: %g %g %g\n", angles.x, angles.y, angles.z );
+}
+
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+
+void JoltPhysicsVehicleWheel::SetUseAlternateGravity( bool bSet )
+{
+}
+
+void JoltPhysicsVehicleWheel::SetCollisionHints( uint32 collisionHints )
+{
+	m_collisionHints = collisionHints;
+}
+
+uint32 JoltPhysicsVehicleWheel::GetCollisionHints() const
+{
+	return m_collisionHints;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+IPredictedPhysicsObject *JoltPhysicsVehicleWheel::GetPredictedInterface() const
+{
+	return nullptr;
+}
+
+void JoltPhysicsVehicleWheel::SyncWith( IPhysicsObject *pOther )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+JPH::Mat44 JoltPhysicsVehicleWheel::GetWheelTransform() const
+{
+	m_pController->GetWheelWorldTransform( m_nWheelIndex, m_CachedTransform );
+	return m_CachedTransform;
+}
+
+JoltPhysicsObject *JoltPhysicsVehicleWheel::GetCarBodyObject() const
+{
+	return m_pController->GetCarBodyObject();
+}
@@ -0,0 +1,178 @@
+//=================================================================================================
+//
+// A vehicle wheel
+//
+//=================================================================================================
+
+#pragma once
+
+#include "vjolt_object.h" // IPhysicsObjectInterface
+
+class JoltPhysicsVehicleController;
+
+// The game wants an IPhysicsObject per wheel so it can pose the wheels
+// and hang its game data off of them, but the vehicle constraint already
+// simulates them. So these have no Jolt body at all, their transforms are
+// worked out from the constraint's wheel state whenever the game asks.
+class JoltPhysicsVehicleWheel final : public IPhysicsObjectInterface
+{
+public:
+	JoltPhysicsVehicleWheel( JoltPhysicsVehicleController *pController, int nWheelIndex, float flRadius, int nMaterialIndex, const objectparams_t &params );
+	~JoltPhysicsVehicleWheel() override;
+
+	bool			IsStatic() const override;
+	bool			IsAsleep() const override;
+	bool			IsTrigger() const override;
+	bool			IsFluid() const override;
+	bool			IsHinged() const override;
+	bool			IsCollisionEnabled() const override;
+	bool			IsGravityEnabled() const override;
+	bool			IsDragEnabled() const override;
+	bool			IsMotionEnabled() const override;
+	bool			IsMoveable() const override;
+	bool			IsAttachedToConstraint( bool bExternalOnly ) const override;
+
+	void			EnableCollisions( bool enable ) override;
+	void			EnableGravity( bool enable ) override;
+	void			EnableDrag( bool enable ) override;
+	void			EnableMotion( bool enable ) override;
+
+	void			SetGameData( void *pGameData ) override;
+	void *			GetGameData() const override;
+	void			SetGameFlags( unsigned short userFlags ) override;
+	unsigned short	GetGameFlags() const override;
+	void			SetGameIndex( unsigned short gameIndex ) override;
+	unsigned short	GetGameIndex() const override;
+
+	void			SetCallbackFlags( unsigned short callbackflags ) override;
+	unsigned short	GetCallbackFlags() const override;
+
+	void			Wake() override;
+	void			Sleep() override;
+	void			RecheckCollisionFilter() override;
+	void			RecheckContactPoints( bool bSearchForNewContacts ) override_portal2;
+	void			RecheckContactPoints() override_not_portal2 { RecheckContactPoints( false ); }
+
+	void			SetMass( float mass ) override;
+	float			GetMass() const override;
+	float			GetInvMass() const override;
+	Vector			GetInertia() const override;
+	Vector			GetInvInertia() const override;
+	void			SetInertia( const Vector &inertia ) override;
+
+	void			SetDamping( const float *speed, const float *rot ) override;
+	void			GetDamping( float *speed, float *rot ) const override;
+
+	void			SetDragCoefficient( float *pDrag, float *pAngularDrag ) override;
+	void			SetBuoyancyRatio( float ratio ) override;
+
+	int				GetMaterialIndex() const override;
+	void			SetMaterialIndex( int materialIndex ) override;
+
+	unsigned int	GetContents() const override;
+	void			SetContents( unsigned int contents ) override;
+
+	float			GetSphereRadius() const override;
+	void			SetSphereRadius( float radius ) override_asw;
+	float			GetEnergy() const override;
+	Vector			GetMassCenterLocalSpace() const override;
+
+	void			SetPosition( const Vector &worldPosition, const QAngle &angles, bool isTeleport ) override;
+	void			SetPositionMatrix( const matrix3x4_t &matrix, bool isTeleport ) override;
+
+	void			GetPosition( Vector *worldPosition, QAngle *angles ) const override;
+	void			GetPositionMatrix( matrix3x4_t *positionMatrix ) const override;
+	void			SetVelocity( const Vector *velocity, const AngularImpulse *angularVelocity ) override;
+
+	void			SetVelocityInstantaneous( const Vector *velocity, const AngularImpulse *angularVelocity ) override;
+
+	void			GetVelocity( Vector *velocity, AngularImpulse *angularVelocity ) const override;
+
+	void			AddVelocity( const Vector *velocity, const AngularImpulse *angularVelocity ) override;
+	void			GetVelocityAtPoint( const Vector &worldPosition, Vector *pVelocity ) const override;
+	void			GetImplicitVelocity( Vector *velocity, AngularImpulse *angularVelocity ) const override;
+	void			LocalToWorld( Vector *worldPosition, const Vector &localPosition ) const override;
+	void			WorldToLocal( Vector *localPosition, const Vector &worldPosition ) const override;
+
+	void			LocalToWorldVector( Vector *worldVector, const Vector &localVector ) const override;
+	void			WorldToLocalVector( Vector *localVector, const Vector &worldVector ) const override;
+
+	void			ApplyForceCenter( const Vector &forceVector ) override;
+	void			ApplyForceOffset( const Vector &forceVector, const Vector &worldPosition ) override;
+	void			ApplyTorqueCenter( const AngularImpulse &torque ) override;
+
+	void			CalculateForceOffset( const Vector &forceVector, const Vector &worldPosition, Vector *centerForce, AngularImpulse *centerTorque ) const override;
+	void			CalculateVelocityOffset( const Vector &forceVector, const Vector &worldPosition, Vector *centerVelocity, AngularImpulse *centerAngularVelocity ) const override;
+	float			CalculateLinearDrag( const Vector &unitDirection ) const override;
+	float			CalculateAngularDrag( const Vector &objectSpaceRotationAxis ) const override;
+
+	bool			GetContactPoint( Vector *contactPoint, IPhysicsObject **contactObject ) const override;
+
+	void			SetShadow( float maxSpeed, float maxAngularSpeed, bool allowPhysicsMovement, bool allowPhysicsRotation ) override;
+	void			UpdateShadow( const Vector &targetPosition, const QAngle &targetAngles, bool tempDisableGravity, float timeOffset ) override;
+
+	int							GetShadowPosition( Vector *position, QAngle *angles ) const override;
+	IPhysicsShadowController *	GetShadowController() const override;
+	void						RemoveShadowController() override;
+	float						ComputeShadowControl( const hlshadowcontrol_params_t &params, float secondsToArrival, float dt ) override;
+
+
+	const CPhysCollide *	GetCollide() const override;
+	const char *			GetName() const override;
+
+	void			BecomeTrigger() override;
+	void			RemoveTrigger() override;
+
+	void			BecomeHinged( int localAxis ) override;
+	void			RemoveHinged() override;
+
+	IPhysicsFrictionSnapshot *CreateFrictionSnapshot() override;
+	void DestroyFrictionSnapshot( IPhysicsFrictionSnapshot *pSnapshot ) override;
+
+	void			OutputDebugInfo() const override;
+
+#if OBJECT_WELDING
+	void			WeldToObject( IPhysicsObject *pParent ) override;
+	void			RemoveWeld( IPhysicsObject *pOther ) override;
+	void			RemoveAllWelds() override;
+#endif
+
+	void			SetUseAlternateGravity( bool bSet ) override_asw;
+	void			SetCollisionHints( uint32 collisionHints ) override_asw;
+	uint32			GetCollisionHints() const override_asw;
+
+	IPredictedPhysicsObject *	GetPredictedInterface() const override_csgo;
+	void						SyncWith( IPhysicsObject *pOther ) override_csgo;
+
+	void SetErrorDelta_Position( const Vector& vPosition ) override_csgo {}
+	void SetErrorDelta_Velocity( const Vector& vVelocity ) override_csgo {}
+
+private:
+	// Gets the wheel's transform from the vehicle constraint, or the last one we saw
+	// if the vehicle has lost its body.
+	JPH::Mat44 GetWheelTransform() const;
+
+	JoltPhysicsObject *GetCarBodyObject() const;
+
+	// Same as JoltPhysicsObject, games read this by offsetting
+	// past the vtable, so it must stay the first member.
+	void							*m_pGameData = nullptr;
+
+	JoltPhysicsVehicleController	*m_pController = nullptr;
+	int								m_nWheelIndex = 0;
+
+	JPH::Ref< JPH::Shape >			m_pShape;
+	mutable JPH::Mat44				m_CachedTransform = JPH::Mat44::sIdentity();
+
+	unsigned short					m_gameFlags = 0;
+	unsigned short					m_gameIndex = 0;
+	unsigned short					m_callbackFlags = CALLBACK_IS_VEHICLE_WHEEL;
+	int								m_materialIndex = 0;
+	unsigned int					m_contents = CONTENTS_SOLID;
+	uint32							m_collisionHints = 0;
+
+	float							m_flRadius = 0.0f;
+	float							m_flMass = 0.0f;
+	float							m_flDamping = 0.0f;
+	float							m_flRotDamping = 0.0f;
+};